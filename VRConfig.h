@@ -0,0 +1,159 @@
+/**
+  ******************************************************************************
+  * @file    VRConfig.h
+  * @author  Elechouse Team
+  * @brief   Build configuration of the VoiceRecognitionV3 library.
+  ******************************************************************************
+    @note
+         The library is compiled apart from the sketch, a #define in the
+         sketch does not reach it. Edit the values here, or pass them as
+         compiler flags(-DVR_ENABLE_TRAIN=0) for the whole build.
+  ******************************************************************************
+  * @section  HISTORY
+
+    2026/10/17    Initial version.
+
+  ******************************************************************************
+  */
+
+#ifndef __VR_CONFIG_H
+#define __VR_CONFIG_H
+
+/***************************************************************************/
+/** command families, 0 removes the functions, their RAM and their hooks in
+    the receive path. See README "Feature selection". */
+
+/** train(), trainWithSignature(), setPromptCallback() */
+#ifndef VR_ENABLE_TRAIN
+#define VR_ENABLE_TRAIN							(1)
+#endif
+
+/** setGroupControl(), checkGroupControl(), setUserGroup(), checkUserGroup(),
+    loadSystemGroup(), loadUserGroup() */
+#ifndef VR_ENABLE_GROUP
+#define VR_ENABLE_GROUP							(1)
+#endif
+
+/** setIOMode(), resetIO(), setPulseWidth(), setAutoLoad(), disableAutoLoad(),
+    restoreSystemSettings() */
+#ifndef VR_ENABLE_SETTINGS
+#define VR_ENABLE_SETTINGS						(1)
+#endif
+
+/** test() */
+#ifndef VR_ENABLE_TEST
+#define VR_ENABLE_TEST							(1)
+#endif
+
+/** xxxAsync(), process(), batches, VRScheduler and applyProfile() */
+#ifndef VR_ENABLE_ASYNC
+#define VR_ENABLE_ASYNC							(1)
+#endif
+
+/** recognizer shadow, resync(), getRecognizer(), setActiveRecords() */
+#ifndef VR_ENABLE_SHADOW
+#define VR_ENABLE_SHADOW						(1)
+#endif
+
+/** trained record cache, isTrained(), getTrainedMap(), refreshRecordCache() */
+#ifndef VR_ENABLE_RECORD_CACHE
+#define VR_ENABLE_RECORD_CACHE					(1)
+#endif
+
+/** signature cache in EEPROM, loadSignatureCache(), getSignature(). Off by
+    default, it takes 4 + 80*(VR_SIG_CACHE_LEN+1) bytes from
+    VR_SIG_CACHE_BASE. Needs VR_ENABLE_RECORD_CACHE. */
+#ifndef VR_ENABLE_SIG_CACHE
+#define VR_ENABLE_SIG_CACHE						(0)
+#endif
+
+/***************************************************************************/
+/** blocking Serial prints of the library, see VR_TRACE_SIZE for a trace
+    which adds no latency */
+//#define DEBUG
+
+#ifndef VR_DEFAULT_TIMEOUT
+#define VR_DEFAULT_TIMEOUT						(1000)
+#endif
+/** floor and ceiling of adaptive timeouts, ms */
+#ifndef VR_RTO_MIN
+#define VR_RTO_MIN								(20)
+#endif
+#ifndef VR_RTO_MAX
+#define VR_RTO_MAX								(VR_DEFAULT_TIMEOUT)
+#endif
+/** shortest wait for the next frame of a multi-frame response(all records, 
+    all user groups, recognizer read), ms. The module may pause longer 
+    between these frames than the measured round trip. */
+#ifndef VR_FRAME_GAP
+#define VR_FRAME_GAP							(500)
+#endif
+#ifndef VR_TEST_FRAME_GAP
+#define VR_TEST_FRAME_GAP						(4000)
+#endif
+
+/** receive buffer of each VR instance, longest frame the module sends */
+#ifndef VR_BUF_SIZE
+#define VR_BUF_SIZE								(32)
+#endif
+/** longest record signature, frames with a longer one do not fit VR_BUF_SIZE */
+#ifndef VR_SIG_MAX
+#define VR_SIG_MAX								(VR_BUF_SIZE-9)
+#endif
+/** silence in a frame after which the receiver resyncs, ms */
+#ifndef VR_RX_GAP
+#define VR_RX_GAP								(20)
+#endif
+/** number of VR instances the registry can hold */
+#ifndef VR_MAX_INSTANCES
+#define VR_MAX_INSTANCES						(4)
+#endif
+/** EEPROM area used by the library(AVR only) */
+#ifndef VR_EEPROM_BASE
+#define VR_EEPROM_BASE							(0)
+#endif
+/** EEPROM byte keeping the last module baud rate for detectBaudRate()(AVR 
+    only). Not defined by default, the rate is then kept in RAM only and 
+    the library writes no EEPROM unless VR_ENABLE_SIG_CACHE is set. */
+//#define VR_EEPROM_BAUD						(VR_EEPROM_BASE)
+/** EEPROM area of the signature cache, after the baud rate byte */
+#ifndef VR_SIG_CACHE_BASE
+#define VR_SIG_CACHE_BASE						(VR_EEPROM_BASE+1)
+#endif
+/** longest cached signature, longer ones are always asked from module */
+#ifndef VR_SIG_CACHE_LEN
+#define VR_SIG_CACHE_LEN						(10)
+#endif
+/** module answer time allowed by detectBaudRate() probes, ms */
+#ifndef VR_BAUD_PROBE_TURNAROUND
+#define VR_BAUD_PROBE_TURNAROUND				(20)
+#endif
+
+/** events kept by the trace ring, power of 2, 0 disables the trace */
+#ifndef VR_TRACE_SIZE
+#define VR_TRACE_SIZE							(16)
+#endif
+
+/** passes of snapshotRecognizer()/restoreRecognizer() over missing chunks */
+#ifndef VR_SNAPSHOT_RETRY
+#define VR_SNAPSHOT_RETRY						(3)
+#endif
+
+/** default listen window of VRScheduler, ms */
+#ifndef VR_LISTEN_WINDOW
+#define VR_LISTEN_WINDOW						(100)
+#endif
+
+/** asynchronous command queue */
+#ifndef VR_CMD_QUEUE_SIZE
+#define VR_CMD_QUEUE_SIZE						(4)
+#endif
+#ifndef VR_CMD_DATA_SIZE
+#define VR_CMD_DATA_SIZE						(22)
+#endif
+/** frames sent ahead of responses in a batch */
+#ifndef VR_PIPELINE_DEPTH
+#define VR_PIPELINE_DEPTH						(3)
+#endif
+
+#endif // __VR_CONFIG_H
@@ -0,0 +1,133 @@
+/**
+  ******************************************************************************
+  * @file    VRDispatch.h
+  * @author  Elechouse Team
+  * @brief   Recognized record to handler table, built at compile time.
+  ******************************************************************************
+    @note
+         List the groups and the handlers once, VR_DISPATCH_TABLE() builds a
+         table in flash:
+
+           #define LAMP_GROUPS(G) \
+             G(VR_GROUP_NONE) \
+             G(VR_GROUP_USER(1))
+           #define LAMP_ACTIONS(X) \
+             X(VR_GROUP_NONE, 0, lightOn) \
+             X(VR_GROUP_NONE, 1, lightOff) \
+             X(VR_GROUP_USER(1), 0, fanOn)
+           VR_DISPATCH_TABLE(LampActions, LAMP_GROUPS, LAMP_ACTIONS)
+
+           if(myVR.recognize(res) > 0){
+             LampActions::dispatch(res);
+           }
+
+         Each group is a row of 80 handlers(2 bytes each on AVR), a lookup
+         is a switch on the group and one flash read, whatever the number of
+         handlers. A record listed twice in a group, a record out of 0~79, a
+         group listed twice or a handler of a group not in GROUPS do not
+         compile. The table is defined where VR_DISPATCH_TABLE() is used,
+         use it in one source file.
+  ******************************************************************************
+  * @section  HISTORY
+
+    2026/10/17    Initial version.
+
+  ******************************************************************************
+  */
+#ifndef __VR_DISPATCH_H
+#define __VR_DISPATCH_H
+
+#include "VoiceRecognitionV3.h"
+
+/** group of a recognized record, RecognitionResult::groupMode() */
+#define VR_GROUP_NONE							(0xFF)
+#define VR_GROUP_SYSTEM(grp)					((uint8_t)(grp))
+#define VR_GROUP_USER(grp)						((uint8_t)(0x80|(grp)))
+
+/** handler of a recognized record */
+typedef void (*vr_handler_t)(const VRCore::RecognitionResult &res);
+
+/** row of a group as a constant, the group list is never read at run time */
+template<uint8_t row> struct vr_dispatch_row{
+	enum { value = row };
+};
+
+/** G(group) and X(group, record, handler) expanders used by VR_DISPATCH_TABLE() */
+#define VR_DISPATCH_GROUP(grp)							(grp),
+#define VR_DISPATCH_PICK(grp, rec, fn)					\
+	((g_) == (grp) && (r_) == (rec)) ? &fn :
+#define VR_DISPATCH_COUNT(grp, rec, fn)					\
+	+ ((g_) == (grp) && (r_) == (rec))
+#define VR_DISPATCH_CHECK(grp, rec, fn)					\
+	static_assert((rec) >= 0 && (rec) < 80, "record must be 0~79");	\
+	static_assert(list_::count(grp, rec) == 1, "record listed twice for a group");	\
+	static_assert(list_::row(grp) < list_::groups(), "group of a handler not listed in GROUPS");
+#define VR_DISPATCH_ROW_CASE(grp)						\
+	case (grp):											\
+		row_ = vr_dispatch_row<list_::row(grp)>::value;	\
+		break;
+#define VR_DISPATCH_ROW(grp)							\
+	{ VR_DISPATCH_R40(grp, 0), VR_DISPATCH_R40(grp, 40) },
+#define VR_DISPATCH_R40(grp, r)							\
+	VR_DISPATCH_R10(grp, r), VR_DISPATCH_R10(grp, r+10),		\
+	VR_DISPATCH_R10(grp, r+20), VR_DISPATCH_R10(grp, r+30)
+#define VR_DISPATCH_R10(grp, r)							\
+	list_::pick(grp, r), list_::pick(grp, r+1), list_::pick(grp, r+2),	\
+	list_::pick(grp, r+3), list_::pick(grp, r+4), list_::pick(grp, r+5),	\
+	list_::pick(grp, r+6), list_::pick(grp, r+7), list_::pick(grp, r+8),	\
+	list_::pick(grp, r+9)
+
+/**
+	Define struct table with the handlers of LIST, an X-macro list of
+	X(group, record, handler) entries, for the groups of GROUPS, an X-macro
+	list of G(group) entries.
+	table::handler(group, record) --> handler in flash, 0 if not listed.
+	table::dispatch(res) --> call the handler of a recognized record, false
+	                         if none.
+*/
+#define VR_DISPATCH_TABLE(table, GROUPS, LIST)			\
+struct table##_list_{									\
+	static constexpr vr_handler_t pick(uint8_t g_, uint8_t r_){	\
+		return LIST(VR_DISPATCH_PICK) (vr_handler_t)0;	\
+	}													\
+	static constexpr uint8_t count(uint8_t g_, uint8_t r_){	\
+		return 0 LIST(VR_DISPATCH_COUNT);				\
+	}													\
+	static constexpr uint8_t groups(){					\
+		return sizeof(grp_)/sizeof(grp_[0]);			\
+	}													\
+	static constexpr uint8_t row(uint8_t g, uint8_t i = 0){	\
+		return i >= groups() || grp_[i] == g ? i : row(g, i+1);	\
+	}													\
+	static constexpr uint8_t grp_[] = { GROUPS(VR_DISPATCH_GROUP) };	\
+};														\
+struct table{											\
+	typedef table##_list_ list_;						\
+	LIST(VR_DISPATCH_CHECK)								\
+	static const vr_handler_t rows[list_::groups()][80];	\
+	static vr_handler_t handler(uint8_t group, uint8_t record){	\
+		uint8_t row_;									\
+		switch(group){									\
+			GROUPS(VR_DISPATCH_ROW_CASE)				\
+			default:									\
+				return 0;								\
+		}												\
+		if(record >= 80){								\
+			return 0;									\
+		}												\
+		return (vr_handler_t)pgm_read_ptr(&rows[row_][record]);	\
+	}													\
+	static bool dispatch(const VRCore::RecognitionResult &res){	\
+		vr_handler_t fn = res.valid() ? handler(res.groupMode(), res.record()) : 0;	\
+		if(fn == 0){									\
+			return false;								\
+		}												\
+		fn(res);										\
+		return true;									\
+	}													\
+};														\
+const vr_handler_t table::rows[table##_list_::groups()][80] PROGMEM = {	\
+	GROUPS(VR_DISPATCH_ROW)								\
+};
+
+#endif // __VR_DISPATCH_H
@@ -0,0 +1,204 @@
+/**
+  ******************************************************************************
+  * @file    VRPosixTransport.cpp
+  * @author  Elechouse Team
+  * @brief   POSIX tty transport, run VRCore on a Linux host.
+  ******************************************************************************
+  */
+#if !defined(ARDUINO)
+
+#include "VRPosixTransport.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <time.h>
+
+/**
+	@brief millisecond clock used by VRCore timeouts on host builds.
+*/
+unsigned long millis()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long)ts.tv_sec*1000 + ts.tv_nsec/1000000;
+}
+
+/**
+	@brief VRPosixTransport class constructor, the tty is opened by begin().
+	@param path --> tty device, e.g. "/dev/ttyUSB0"
+*/
+VRPosixTransport::VRPosixTransport(const char *path) : path(path)
+{
+	fd = -1;
+	rx_head = 0;
+	rx_tail = 0;
+	tx_cnt = 0;
+}
+
+VRPosixTransport::~VRPosixTransport()
+{
+	if(fd >= 0){
+		close(fd);
+	}
+}
+
+/**
+	@brief open the tty if needed, set raw mode 8N1 and link speed.
+	@param baud --> 2400, 4800, 9600, 19200, 38400
+	@retval 0 --> success
+	        -1 --> rate not supported, or tty can not be opened or set
+*/
+int VRPosixTransport :: begin(unsigned long baud)
+{
+	struct termios tio;
+	speed_t speed;
+	
+	switch(baud){
+		case 2400:
+			speed = B2400;
+			break;
+		case 4800:
+			speed = B4800;
+			break;
+		case 9600:
+			speed = B9600;
+			break;
+		case 19200:
+			speed = B19200;
+			break;
+		case 38400:
+			speed = B38400;
+			break;
+		default:
+			return -1;
+	}
+	
+	if(fd < 0){
+		fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+		if(fd < 0){
+			return -1;
+		}
+	}
+	if(tcgetattr(fd, &tio) != 0){
+		return -1;
+	}
+	cfmakeraw(&tio);
+	tio.c_cflag |= CLOCAL | CREAD;
+	tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+	tio.c_cc[VMIN] = 0;
+	tio.c_cc[VTIME] = 0;
+	cfsetispeed(&tio, speed);
+	cfsetospeed(&tio, speed);
+	if(tcsetattr(fd, TCSANOW, &tio) != 0){
+		return -1;
+	}
+	tcflush(fd, TCIOFLUSH);
+	rx_head = 0;
+	rx_tail = 0;
+	tx_cnt = 0;
+	return 0;
+}
+
+/** move bytes waiting in the tty into rx_buf, never blocks */
+void VRPosixTransport :: fill()
+{
+	ssize_t n;
+	if(fd < 0){
+		return;
+	}
+	if(rx_head == rx_tail){
+		rx_head = 0;
+		rx_tail = 0;
+	}
+	if(rx_tail >= sizeof(rx_buf)){
+		return;
+	}
+	n = ::read(fd, rx_buf+rx_tail, sizeof(rx_buf)-rx_tail);
+	if(n > 0){
+		rx_tail += n;
+	}
+}
+
+int VRPosixTransport :: available()
+{
+	fill();
+	return rx_tail - rx_head;
+}
+
+int VRPosixTransport :: read()
+{
+	if(rx_head == rx_tail){
+		fill();
+		if(rx_head == rx_tail){
+			return -1;
+		}
+	}
+	return rx_buf[rx_head++];
+}
+
+size_t VRPosixTransport :: write(uint8_t c)
+{
+	return write(&c, 1);
+}
+
+/** keep bytes until flush(), a full buffer is written at once */
+size_t VRPosixTransport :: write(const uint8_t *buf, size_t len)
+{
+	size_t cnt;
+	if(fd < 0){
+		return 0;
+	}
+	for(cnt=0; cnt<len; cnt++){
+		if(tx_cnt >= sizeof(tx_buf) && send() < 0){
+			break;
+		}
+		tx_buf[tx_cnt++] = buf[cnt];
+	}
+	return cnt;
+}
+
+/** write the frame to the tty and wait until it is on the line */
+void VRPosixTransport :: flush()
+{
+	if(send() == 0){
+		tcdrain(fd);
+	}
+}
+
+/** 
+	write tx_buf, the tty is non-blocking: wait for room when it is full, 
+	VR_POSIX_TX_TIMEOUT at most. Bytes not written are dropped.
+*/
+int VRPosixTransport :: send()
+{
+	struct pollfd pfd;
+	uint8_t cnt = 0;
+	ssize_t n;
+	int ret = 0;
+	if(fd < 0){
+		tx_cnt = 0;
+		return -1;
+	}
+	while(cnt < tx_cnt){
+		n = ::write(fd, tx_buf+cnt, tx_cnt-cnt);
+		if(n >= 0){
+			cnt += n;
+			continue;
+		}
+		if(errno == EINTR){
+			continue;
+		}
+		pfd.fd = fd;
+		pfd.events = POLLOUT;
+		if(errno != EAGAIN || poll(&pfd, 1, VR_POSIX_TX_TIMEOUT) <= 0){
+			ret = -1;
+			break;
+		}
+	}
+	tx_cnt = 0;
+	return ret;
+}
+
+#endif // !ARDUINO
@@ -0,0 +1,60 @@
+/**
+  ******************************************************************************
+  * @file    VRPosixTransport.h
+  * @author  Elechouse Team
+  * @brief   POSIX tty transport, run VRCore on a Linux host.
+  ******************************************************************************
+    @note
+         VRPosixTransport link("/dev/ttyUSB0");
+         VRCore myVR(&link);
+         if(myVR.begin(9600) < 0){
+           // tty not found or rate not supported
+         }
+
+         Bytes of a frame are kept and written with one system call by 
+         flush(), so a USB serial adapter sends the frame without gaps.
+  ******************************************************************************
+  */
+#ifndef __VR_POSIX_TRANSPORT_H
+#define __VR_POSIX_TRANSPORT_H
+
+#if !defined(ARDUINO)
+
+#include "VRTransport.h"
+
+/** longest wait for room in the tty output queue, ms */
+#ifndef VR_POSIX_TX_TIMEOUT
+#define VR_POSIX_TX_TIMEOUT						(1000)
+#endif
+
+class VRPosixTransport : public VRTransport{
+public:
+	VRPosixTransport(const char *path);
+	~VRPosixTransport();
+	
+	bool isOpen() const { return fd >= 0; }
+	
+	int available();
+	int read();
+	size_t write(uint8_t c);
+	size_t write(const uint8_t *buf, size_t len);
+	void flush();
+	int begin(unsigned long baud);
+	
+private:
+	const char *path;
+	int fd;
+	uint8_t rx_buf[64];
+	uint8_t rx_head;
+	uint8_t rx_tail;
+	/** frame bytes not written to the tty yet */
+	uint8_t tx_buf[64];
+	uint8_t tx_cnt;
+	
+	void fill();
+	int send();
+};
+
+#endif // !ARDUINO
+
+#endif // __VR_POSIX_TRANSPORT_H
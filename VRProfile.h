@@ -0,0 +1,108 @@
+/**
+  ******************************************************************************
+  * @file    VRProfile.h
+  * @author  Elechouse Team
+  * @brief   Module profile, the settings of a module as one byte array.
+  ******************************************************************************
+    @note
+         A profile lists the frames which set up a module, built at compile
+         time and applied with one call:
+
+           const uint8_t lamp_profile[] PROGMEM = {
+             VR_PROFILE_BEGIN,
+             VR_PROFILE_SIGNATURE(0, 'o', 'n'),
+             VR_PROFILE_SIGNATURE(1, 'o', 'f', 'f'),
+             VR_PROFILE_GROUP(GROUP0, 0, 1),
+             VR_PROFILE_AUTOLOAD(0, 1),
+             VR_PROFILE_IO_MODE(VRCore::TOGGLE),
+             VR_PROFILE_BAUD(38400),
+             VR_PROFILE_END
+           };
+           myVR.applyProfile_P(lamp_profile);
+
+         Layout, bytes only, no alignment or byte order:
+           'V' 'R' 'P' VR_PROFILE_VERSION
+           command, length, frame data   --> one section per frame
+           ...
+           VR_PROFILE_END(0)
+
+         Frame data is sent as it is, so a section is one frame on the wire.
+         The same bytes work from flash(applyProfile_P()), RAM or a file
+         mapped on a host(applyProfile()). Signatures longer than 10 bytes,
+         groups and autoload lists of more than 7 records, recognizer chunks
+         other than 20 bytes and unknown baud rates do not compile.
+  ******************************************************************************
+  * @section  HISTORY
+
+    2026/10/17    Initial version.
+
+  ******************************************************************************
+  */
+#ifndef __VR_PROFILE_H
+#define __VR_PROFILE_H
+
+#include "VoiceRecognitionV3.h"
+
+/** number of arguments, evaluated by the compiler */
+template<typename... T>
+constexpr uint8_t vrCount(T...)
+{
+	return sizeof...(T);
+}
+
+/** module code of a baud rate, 0xFF if the module does not support it */
+constexpr uint8_t vrBaudCode(unsigned long br)
+{
+	return br == 9600 ? 0 : br == 2400 ? 1 : br == 4800 ? 2 :
+		   br == 19200 ? 4 : br == 38400 ? 5 : 0xFF;
+}
+
+/**
+	section length, only defined when ok. An out of range section stops the
+	build with "incomplete type vr_profile_check<false>".
+*/
+template<bool ok> struct vr_profile_check;
+template<> struct vr_profile_check<true>{
+	static constexpr uint8_t len(uint8_t n) { return n; }
+};
+#define VR_PROFILE_LEN(ok, n)			(vr_profile_check<(ok)>::len(n))
+
+/** signature of record, characters or bytes; none deletes it */
+#define VR_PROFILE_SIGNATURE(record, ...)				\
+	FRAME_CMD_SET_SIG,									\
+	VR_PROFILE_LEN(vrCount(__VA_ARGS__) <= 10, 1+vrCount(__VA_ARGS__)),	\
+	(record), ##__VA_ARGS__
+
+/** records of user group grp(GROUP0~GROUP7), 1~7 records */
+#define VR_PROFILE_GROUP(grp, ...)						\
+	FRAME_CMD_GROUP,									\
+	VR_PROFILE_LEN((grp) < 8 && vrCount(__VA_ARGS__) >= 1 && vrCount(__VA_ARGS__) <= 7, \
+		2+vrCount(__VA_ARGS__)),						\
+	FRAME_CMD_GROUP_SUGRP, (grp), __VA_ARGS__
+
+/** records loaded at power on, none disables autoload */
+#define VR_PROFILE_AUTOLOAD(...)						\
+	FRAME_CMD_SET_AL,									\
+	VR_PROFILE_LEN(vrCount(__VA_ARGS__) <= 7, 1+vrCount(__VA_ARGS__)),	\
+	(uint8_t)((1<<vrCount(__VA_ARGS__))-1), ##__VA_ARGS__
+
+/** output IO mode, VRCore::PULSE/TOGGLE/SET/CLEAR */
+#define VR_PROFILE_IO_MODE(mode)						\
+	FRAME_CMD_SET_IOM, VR_PROFILE_LEN((mode) <= 3, 1), (mode)
+
+/** pulse width, VRCore::LEVEL0~LEVEL15 */
+#define VR_PROFILE_PULSE_WIDTH(level)					\
+	FRAME_CMD_SET_PW, VR_PROFILE_LEN((level) <= 15, 1), (level)
+
+/** recognizer chunk index(0~9) of a snapshot, 20 bytes */
+#define VR_PROFILE_RECOGNIZER(index, ...)				\
+	FRAME_CMD_TEST,										\
+	VR_PROFILE_LEN((index) < FRAME_TEST_CHUNK_NUM && vrCount(__VA_ARGS__) == FRAME_TEST_CHUNK_SIZE, \
+		2+FRAME_TEST_CHUNK_SIZE),						\
+	FRAME_CMD_TEST_WRITE, (index), __VA_ARGS__
+
+/** module baud rate after restart, last section */
+#define VR_PROFILE_BAUD(br)								\
+	FRAME_CMD_SET_BR, VR_PROFILE_LEN(vrBaudCode(br) != 0xFF, 1), vrBaudCode(br)
+
+#endif // __VR_PROFILE_H
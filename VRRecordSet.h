@@ -0,0 +1,151 @@
+/**
+  ******************************************************************************
+  * @file    VRRecordSet.h
+  * @author  Elechouse Team
+  * @brief   Set of records 0~79, one bit each.
+  ******************************************************************************
+    @note
+         10 bytes, same layout as getTrainedMap(): record r is bit r&7 of
+         byte r>>3. Membership is one bit test, a record added twice is
+         kept once, and iteration is in ascending order, so record lists
+         need no sort and no duplicate search.
+
+           VRCore::RecordSet want, have;
+           want.add(3); want.add(12);
+           myVR.getTrainedMap(have.data());
+           want &= have;                        // only trained ones
+           for(int r = want.next(); r >= 0; r = want.next(r)){ ... }
+  ******************************************************************************
+  * @section  HISTORY
+
+    2026/10/17    Initial version.
+
+  ******************************************************************************
+  */
+#ifndef __VR_RECORD_SET_H
+#define __VR_RECORD_SET_H
+
+#if defined(ARDUINO)
+ #if ARDUINO >= 100
+  #include "Arduino.h"
+ #else
+  #include "WProgram.h"
+ #endif
+#else
+ #include <stdint.h>
+ #include <string.h>
+#endif
+
+class VRRecordSet{
+public:
+	/** records 0 ~ VR_RECORD_NUM-1 */
+	enum { VR_RECORD_NUM = 80 };
+
+	VRRecordSet() { clear(); }
+	/** records of a list, out of range ones are skipped */
+	VRRecordSet(const uint8_t *records, uint8_t len) {
+		clear();
+		while(len--){
+			add(*records++);
+		}
+	}
+
+	void clear() { memset(bits, 0, sizeof(bits)); }
+	/** false if record is out of range */
+	bool add(uint8_t record) {
+		if(record >= VR_RECORD_NUM){
+			return false;
+		}
+		bits[record>>3] |= 1<<(record&7);
+		return true;
+	}
+	void remove(uint8_t record) {
+		if(record < VR_RECORD_NUM){
+			bits[record>>3] &= ~(1<<(record&7));
+		}
+	}
+	bool contains(uint8_t record) const {
+		return record < VR_RECORD_NUM && (bits[record>>3]>>(record&7))&1;
+	}
+	bool empty() const {
+		for(uint8_t i=0; i<sizeof(bits); i++){
+			if(bits[i]){
+				return false;
+			}
+		}
+		return true;
+	}
+	uint8_t count() const {
+		uint8_t i, b, n = 0;
+		for(i=0; i<sizeof(bits); i++){
+			for(b=bits[i]; b; b&=b-1){
+				n++;
+			}
+		}
+		return n;
+	}
+
+	/**
+		smallest record after record, -1 if none. next() gives the first:
+		for(int r = set.next(); r >= 0; r = set.next(r))
+	*/
+	int next(int record = -1) const {
+		uint8_t r = record+1;
+		while(r < VR_RECORD_NUM){
+			if((r&7) == 0 && bits[r>>3] == 0){
+				r += 8;
+				continue;
+			}
+			if((bits[r>>3]>>(r&7))&1){
+				return r;
+			}
+			r++;
+		}
+		return -1;
+	}
+
+	/** records in ascending order, frame payload of load(), setUserGroup()...
+	    @retval number of records written, max at most */
+	uint8_t toArray(uint8_t *buf, uint8_t max) const {
+		uint8_t n = 0;
+		int r;
+		for(r=next(); r>=0 && n<max; r=next(r)){
+			buf[n++] = r;
+		}
+		return n;
+	}
+
+	/** bit map, 10 bytes */
+	uint8_t *data() { return bits; }
+	const uint8_t *data() const { return bits; }
+
+	/** union, intersection, difference */
+	VRRecordSet &operator|=(const VRRecordSet &s) {
+		for(uint8_t i=0; i<sizeof(bits); i++){
+			bits[i] |= s.bits[i];
+		}
+		return *this;
+	}
+	VRRecordSet &operator&=(const VRRecordSet &s) {
+		for(uint8_t i=0; i<sizeof(bits); i++){
+			bits[i] &= s.bits[i];
+		}
+		return *this;
+	}
+	VRRecordSet &operator-=(const VRRecordSet &s) {
+		for(uint8_t i=0; i<sizeof(bits); i++){
+			bits[i] &= ~s.bits[i];
+		}
+		return *this;
+	}
+	VRRecordSet operator|(const VRRecordSet &s) const { VRRecordSet r(*this); return r |= s; }
+	VRRecordSet operator&(const VRRecordSet &s) const { VRRecordSet r(*this); return r &= s; }
+	VRRecordSet operator-(const VRRecordSet &s) const { VRRecordSet r(*this); return r -= s; }
+	bool operator==(const VRRecordSet &s) const { return memcmp(bits, s.bits, sizeof(bits)) == 0; }
+	bool operator!=(const VRRecordSet &s) const { return !(*this == s); }
+
+private:
+	uint8_t bits[VR_RECORD_NUM/8];
+};
+
+#endif // __VR_RECORD_SET_H
@@ -0,0 +1,101 @@
+/**
+  ******************************************************************************
+  * @file    VRSignatureDict.h
+  * @author  Elechouse Team
+  * @brief   Record names kept in flash, resolved without the module.
+  ******************************************************************************
+    @note
+         List the records once, VR_SIGNATURE_DICT() builds the lookups at
+         compile time:
+
+           #define LAMP_SIGNATURES(X) \
+             X(0, "on") \
+             X(1, "off") \
+             X(5, "blink")
+           VR_SIGNATURE_DICT(LampDict, LAMP_SIGNATURES)
+
+           LampDict::name(5)        --> "blink" in flash, 0 if not listed
+           LampDict::record("off")  --> 1, -1 if not listed
+
+         Names stay in flash, lookups never copy them to RAM and never talk
+         to the module. Names are switch cases, so a record listed twice, a
+         record out of 0~79 or two names with the same hash do not compile.
+         For the last one change VR_SIG_HASH_SEED.
+  ******************************************************************************
+  * @section  HISTORY
+
+    2026/10/17    Initial version.
+
+  ******************************************************************************
+  */
+#ifndef __VR_SIGNATURE_DICT_H
+#define __VR_SIGNATURE_DICT_H
+
+#include "VoiceRecognitionV3.h"
+
+#ifndef VR_SIG_HASH_SEED
+#define VR_SIG_HASH_SEED						(5381)
+#endif
+
+/** hash of a name(djb2, 16 bits), also evaluated by the compiler */
+constexpr uint16_t vrSigHash(const char *sig, uint8_t len, uint16_t h = VR_SIG_HASH_SEED)
+{
+	return len == 0 ? h : vrSigHash(sig+1, len-1, (uint16_t)((h<<5) + h + (uint8_t)*sig));
+}
+
+/** X(record, name) expanders used by VR_SIGNATURE_DICT() */
+#define VR_SIG_NAME_CASE(rec, str)						\
+	case rec:											\
+		static_assert((rec) >= 0 && (rec) < 80, "record must be 0~79");	\
+		static_assert(sizeof(str) > 1, "name must not be empty");			\
+		return PSTR(str);
+#define VR_SIG_HASH_CASE(rec, str)						\
+	case vrSigHash(str, sizeof(str)-1):				\
+		rec_ = rec;										\
+		break;
+#define VR_SIG_COUNT(rec, str)							+1
+
+/**
+	Define struct dict with the records and names of LIST, an X-macro list
+	of X(record, name) entries.
+	dict::name(record) --> name in flash(PGM_P), 0 if record is not listed.
+	dict::name(res) --> name of a recognized record.
+	dict::record(sig, len) --> record of a name, -1 if not listed. len 0
+	                           means sig is a C string.
+	dict::count() --> number of listed records.
+*/
+#define VR_SIGNATURE_DICT(dict, LIST)					\
+struct dict{											\
+	static const char *name(uint8_t record){			\
+		switch(record){									\
+			LIST(VR_SIG_NAME_CASE)						\
+			default:									\
+				return 0;								\
+		}												\
+	}													\
+	static const char *name(const VRCore::RecognitionResult &res){	\
+		return res.valid() ? name(res.record()) : 0;	\
+	}													\
+	static int record(const char *sig, uint8_t len = 0){	\
+		int rec_;										\
+		const char *p;									\
+		if(len == 0){									\
+			len = strlen(sig);							\
+		}												\
+		switch(vrSigHash(sig, len)){					\
+			LIST(VR_SIG_HASH_CASE)						\
+			default:									\
+				return -1;								\
+		}												\
+		p = name(rec_);									\
+		if(strlen_P(p) != len || memcmp_P(sig, p, len) != 0){	\
+			return -1;									\
+		}												\
+		return rec_;									\
+	}													\
+	static uint8_t count(){								\
+		return 0 LIST(VR_SIG_COUNT);					\
+	}													\
+};
+
+#endif // __VR_SIGNATURE_DICT_H
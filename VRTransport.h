@@ -0,0 +1,89 @@
+/**
+  ******************************************************************************
+  * @file    VRTransport.h
+  * @author  Elechouse Team
+  * @brief   Byte transports of the Voice Recognition V3 protocol.
+  ******************************************************************************
+    @note
+         VRCore talks to the module through VRTransport, so the same protocol 
+         code runs over SoftwareSerial, HardwareSerial, any Stream, or a 
+         POSIX tty on a Linux host(VRPosixTransport.h).
+  ******************************************************************************
+  */
+#ifndef __VR_TRANSPORT_H
+#define __VR_TRANSPORT_H
+
+#if defined(ARDUINO)
+ #if ARDUINO >= 100
+  #include "Arduino.h"
+ #else
+  #include "WProgram.h"
+ #endif
+#else
+ #include <stdint.h>
+ #include <stddef.h>
+#endif
+
+class VRTransport{
+public:
+	/** number of received bytes ready to read */
+	virtual int available() = 0;
+	/** one received byte, -1 if none, never blocks */
+	virtual int read() = 0;
+	virtual size_t write(uint8_t c) = 0;
+	virtual size_t write(const uint8_t *buf, size_t len) {
+		size_t i;
+		for(i=0; i<len; i++){
+			write(buf[i]);
+		}
+		return len;
+	}
+	/** end of a frame, bytes kept by write() go out now */
+	virtual void flush() {}
+	/** set link speed, 0: success, -1: rate not supported or port not open */
+	virtual int begin(unsigned long baud) = 0;
+	/** false if the port can not receive now(SoftwareSerial not listening) */
+	virtual bool isListening() { return true; }
+	/** false if the port can not receive while it sends(SoftwareSerial) */
+	virtual bool isFullDuplex() { return true; }
+};
+
+/**
+	transport over a serial port class with begin(), e.g. HardwareSerial, 
+	SoftwareSerial.
+*/
+template<class T>
+class VRSerialTransport : public VRTransport{
+public:
+	VRSerialTransport(T &serial) : serial(serial) {}
+	
+	int available() { return serial.available(); }
+	int read() { return serial.read(); }
+	size_t write(uint8_t c) { return serial.write(c); }
+	size_t write(const uint8_t *buf, size_t len) { return serial.write(buf, len); }
+	int begin(unsigned long baud) { serial.begin(baud); return 0; }
+	
+protected:
+	T &serial;
+};
+
+#if defined(ARDUINO) && ARDUINO >= 100
+/**
+	transport over any Stream, link speed is set by its owner.
+*/
+class VRStreamTransport : public VRTransport{
+public:
+	VRStreamTransport(Stream &stream) : stream(stream) {}
+	
+	int available() { return stream.available(); }
+	int read() { return stream.read(); }
+	size_t write(uint8_t c) { return stream.write(c); }
+	size_t write(const uint8_t *buf, size_t len) { return stream.write(buf, len); }
+	int begin(unsigned long baud) { (void)baud; return 0; }
+	
+private:
+	Stream &stream;
+};
+#endif
+
+#endif // __VR_TRANSPORT_H
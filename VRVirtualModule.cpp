@@ -0,0 +1,620 @@
+/**
+  ******************************************************************************
+  * @file    VRVirtualModule.cpp
+  * @author  Elechouse Team
+  * @brief   In-memory Voice Recognition V3 module, test VRCore on a host.
+  ******************************************************************************
+  * @section  HISTORY
+
+    2026/10/17    Initial version.
+
+  ******************************************************************************
+  */
+#if !defined(ARDUINO)
+
+#include "VRVirtualModule.h"
+
+unsigned long long VRVirtualModule::clock_us;
+unsigned long VRVirtualModule::tick_us = 5;
+
+static const char vm_speak_now[] = "Speak now";
+static const char vm_speak_again[] = "Speak again";
+
+/**
+	@brief VRVirtualModule class constructor, records untrained, settings
+	       of a new module.
+	@param baud --> module baud rate.
+*/
+VRVirtualModule::VRVirtualModule(unsigned long baud)
+{
+	duplex = true;
+	host_baud = 0;
+	module_baud = baud;
+	pend_baud = baud;
+	speak_us = 100000;
+	setJitter(0);
+	setTurnaround(3000);
+	memset(trained, 0, sizeof(trained));
+	memset(sig_len, 0, sizeof(sig_len));
+	train_fail = 0;
+	memset(slot, 0xFF, sizeof(slot));
+	grpm = 0xFF;
+	memset(ugrp, 0xFF, sizeof(ugrp));
+	for(int i=0; i<(int)sizeof(bsr); i++){
+		bsr[i] = i;
+	}
+	iom = 0;
+	pw = 0;
+	al = 0;
+	al_num = 0;
+	gctl = 0;
+	rx_len = 0;
+	tx_head = 0;
+	tx_cnt = 0;
+	tx_last = 0;
+	fdrop_cnt = 0;
+	fdrop_skip = 0;
+	bdrop_cnt = 0;
+	bdrop_skip = 0;
+	bbad_cnt = 0;
+	bbad_skip = 0;
+	fdelay_us = 0;
+	fdelay_skip = 0;
+	resetStats();
+}
+
+/** virtual milliseconds, one CPU tick per call */
+unsigned long VRVirtualModule :: millis()
+{
+	clock_us += tick_us;
+	return clock_us/1000;
+}
+
+int VRVirtualModule :: begin(unsigned long baud)
+{
+	host_baud = baud;
+	return 0;
+}
+
+int VRVirtualModule :: available()
+{
+	int n;
+	clock_us += tick_us;
+	for(n=0; n<tx_cnt && tx_buf[(tx_head+n)%VR_VM_TX_SIZE].at<=clock_us; n++);
+	return n;
+}
+
+int VRVirtualModule :: read()
+{
+	uint8_t ch;
+	clock_us += tick_us;
+	if(tx_cnt == 0 || tx_buf[tx_head].at > clock_us){
+		return -1;
+	}
+	ch = tx_buf[tx_head].ch;
+	tx_head = (tx_head+1)%VR_VM_TX_SIZE;
+	tx_cnt--;
+	/** sampled at another baud rate */
+	return host_baud == module_baud ? ch : ch^0x33;
+}
+
+/**
+	@brief one byte from host, takes its wire time. Frames are parsed like
+	       the module does: a byte other than FRAME_HEAD starts over, a frame
+	       with a wrong FRAME_END is dropped.
+*/
+size_t VRVirtualModule :: write(uint8_t c)
+{
+	unsigned long t = byteTime(host_baud ? host_baud : module_baud);
+	uint16_t i, k;
+
+	for(i=0; !duplex && i<tx_cnt; i++){
+		/** receiver of host is off while it sends */
+		k = (tx_head+i)%VR_VM_TX_SIZE;
+		if(tx_buf[k].at > clock_us+t){
+			break;
+		}
+		if(tx_buf[k].at > clock_us){
+			tx_buf[k].ch ^= 0x55;
+		}
+	}
+	clock_us += t;
+	host_bytes++;
+	if(host_baud != module_baud){
+		rx_len = 0;
+		return 1;
+	}
+	rx_buf[rx_len++] = c;
+	if(rx_buf[0] != FRAME_HEAD){
+		rx_len = 0;
+	}else if(rx_len >= 2 && rx_len == rx_buf[1]+2){
+		if(rx_buf[1] >= 2 && c == FRAME_END){
+			frames++;
+			frame(rx_buf+2, rx_buf[1]-1);
+		}
+		rx_len = 0;
+	}
+	return 1;
+}
+
+void VRVirtualModule :: setTurnaround(unsigned long us)
+{
+	int i;
+	for(i=0; i<256; i++){
+		cmd_us[i] = us;
+	}
+}
+
+/**
+	@brief power cycle, the baud rate set by FRAME_CMD_SET_BR is taken,
+	       recognizer is emptied and autoload records are loaded.
+*/
+void VRVirtualModule :: restart()
+{
+	uint8_t i;
+	module_baud = pend_baud;
+	memset(slot, 0xFF, sizeof(slot));
+	grpm = 0xFF;
+	rx_len = 0;
+	tx_cnt = 0;
+	tx_last = clock_us;
+	for(i=0; al && i<al_num && i<7; i++){
+		if(isTrained(al_rec[i])){
+			slot[i] = al_rec[i];
+		}
+	}
+}
+
+/**
+	@brief train a record, as done with the buttons of the module.
+	@param record --> 0~79
+	       sig --> signature, 0 keeps the old one.
+*/
+void VRVirtualModule :: train(uint8_t record, const char *sig)
+{
+	uint8_t len;
+	if(record >= 80){
+		return;
+	}
+	trained[record] = 1;
+	if(sig != 0){
+		len = strlen(sig) < VR_SIG_MAX ? strlen(sig) : VR_SIG_MAX;
+		memcpy(this->sig[record], sig, len);
+		sig_len[record] = len;
+	}
+}
+
+void VRVirtualModule :: untrain(uint8_t record)
+{
+	if(record < 80){
+		trained[record] = 0;
+		sig_len[record] = 0;
+	}
+}
+
+/** signature length, -1 if record is out of range */
+int VRVirtualModule :: getSignature(uint8_t record, uint8_t *buf) const
+{
+	if(record >= 80){
+		return -1;
+	}
+	memcpy(buf, sig[record], sig_len[record]);
+	return sig_len[record];
+}
+
+uint8_t VRVirtualModule :: getAutoLoad(uint8_t *records) const
+{
+	if(!al){
+		return 0;
+	}
+	memcpy(records, al_rec, al_num);
+	return al_num;
+}
+
+/**
+	@brief voice of a loaded record, FRAME_CMD_VR is sent after the
+	       turnaround plus us.
+	@retval false --> record is not in the recognizer.
+*/
+bool VRVirtualModule :: speak(uint8_t record, unsigned long us)
+{
+	uint8_t buf[6+VR_SIG_MAX];
+	uint8_t i;
+	for(i=0; i<7 && slot[i]!=record; i++);
+	if(record >= 80 || i == 7){
+		return false;
+	}
+	buf[0] = FRAME_CMD_VR;
+	buf[1] = 0;
+	buf[2] = grpm;
+	buf[3] = record;
+	buf[4] = i;
+	buf[5] = sig_len[record];
+	memcpy(buf+6, sig[record], sig_len[record]);
+	respond(buf, 6+sig_len[record], us);
+	return true;
+}
+
+/**
+	@brief queue a response frame, ready after the turnaround, then byte by
+	       byte at module baud rate. Injected faults are applied here.
+	@param buf --> command and data.
+	       us --> time added to the turnaround.
+*/
+void VRVirtualModule :: respond(const uint8_t *buf, uint8_t len, unsigned long us)
+{
+	uint8_t frame[3+255];
+	uint16_t i, k;
+	unsigned long long at;
+
+	if(fdrop_cnt){
+		if(fdrop_skip){
+			fdrop_skip--;
+		}else{
+			fdrop_cnt--;
+			return;
+		}
+	}
+	frame[0] = FRAME_HEAD;
+	frame[1] = len+1;
+	memcpy(frame+2, buf, len);
+	frame[len+2] = FRAME_END;
+
+	at = tx_last > clock_us ? tx_last : clock_us;
+	at += cmd_us[buf[0]] + us;
+	if(fdelay_us){
+		if(fdelay_skip){
+			fdelay_skip--;
+		}else{
+			at += fdelay_us;
+			fdelay_us = 0;
+		}
+	}
+	if(jitter_us){
+		seed = seed*1103515245 + 12345;
+		at += (seed>>8) % (jitter_us+1);
+	}
+	for(i=0; i<len+3; i++){
+		at += byteTime(module_baud);
+		if(bdrop_cnt){
+			if(bdrop_skip){
+				bdrop_skip--;
+			}else{
+				bdrop_cnt--;
+				continue;
+			}
+		}
+		if(bbad_cnt){
+			if(bbad_skip){
+				bbad_skip--;
+			}else{
+				bbad_cnt--;
+				frame[i] ^= 0x55;
+			}
+		}
+		if(tx_cnt == VR_VM_TX_SIZE){
+			break;
+		}
+		k = (tx_head+tx_cnt)%VR_VM_TX_SIZE;
+		tx_buf[k].at = at;
+		tx_buf[k].ch = frame[i];
+		tx_cnt++;
+		module_bytes++;
+	}
+	tx_last = at;
+}
+
+void VRVirtualModule :: error(uint8_t cmd)
+{
+	uint8_t buf[2] = {FRAME_CMD_ERROR, cmd};
+	respond(buf, 2);
+}
+
+/** FRAME_CMD_CHECK_TRAIN status of a record */
+uint8_t VRVirtualModule :: recordStatus(uint8_t record) const
+{
+	return record < 80 ? trained[record] : 0xFF;
+}
+
+/** recognizer slots, record number, map and group mode after first */
+uint8_t VRVirtualModule :: checkBsr(uint8_t *buf, uint8_t first) const
+{
+	uint8_t i, n = 0, map = 0;
+	buf[0] = first;
+	for(i=0; i<7; i++){
+		buf[1+i] = slot[i];
+		if(slot[i] != 0xFF){
+			n++;
+			map |= 1<<i;
+		}
+	}
+	buf[8] = n;
+	buf[9] = map;
+	buf[10] = grpm;
+	return 11;
+}
+
+/** one frame from host, command and data */
+void VRVirtualModule :: frame(uint8_t *buf, uint8_t len)
+{
+	uint8_t res[3+256];
+	uint8_t cmd = buf[0];
+	uint8_t *arg = buf+1;
+	uint8_t n = len-1;
+	int i, k, cnt;
+
+	res[0] = cmd;
+	res[1] = 0;
+	switch(cmd){
+		case FRAME_CMD_CHECK_SYSTEM:
+			switch(module_baud){
+				case 2400: res[2] = 1; break;
+				case 4800: res[2] = 2; break;
+				case 19200: res[2] = 4; break;
+				case 38400: res[2] = 5; break;
+				default: res[2] = 0; break;
+			}
+			res[3] = iom;
+			res[4] = pw;
+			res[5] = al;
+			res[6] = gctl;
+			respond(res, 7);
+			break;
+		case FRAME_CMD_CHECK_BSR:
+			for(i=0, k=0; i<7; i++){
+				k += slot[i] != 0xFF;
+			}
+			respond(res, 1+checkBsr(res+1, k));
+			break;
+		case FRAME_CMD_CHECK_TRAIN:
+			for(i=0, cnt=0; i<80; i++){
+				cnt += trained[i];
+			}
+			if(n == 1 && arg[0] == 0xFF){
+				/** all records, 5 each frame */
+				for(i=0; i<51; i++){
+					res[1] = cnt;
+					for(k=0; k<5; k++){
+						res[2+2*k] = i*5+k;
+						res[3+2*k] = recordStatus(i*5+k);
+					}
+					respond(res, 12);
+				}
+				break;
+			}
+			for(i=0, cnt=0; i<n; i++){
+				res[2+2*i] = arg[i];
+				res[3+2*i] = recordStatus(arg[i]);
+				cnt += res[3+2*i] == 1;
+			}
+			res[1] = cnt;
+			respond(res, 2+2*n);
+			break;
+		case FRAME_CMD_CHECK_SIG:
+			res[1] = arg[0];
+			res[2] = arg[0] < 80 ? sig_len[arg[0]] : 0;
+			memcpy(res+3, sig[arg[0]%80], res[2]);
+			respond(res, 3+res[2]);
+			break;
+		case FRAME_CMD_RESET_DEFAULT:
+			iom = 0;
+			pw = 0;
+			al = 0;
+			pend_baud = 9600;
+			respond(res, 2);
+			break;
+		case FRAME_CMD_SET_BR:
+			switch(arg[0]){
+				case 1: pend_baud = 2400; break;
+				case 2: pend_baud = 4800; break;
+				case 4: pend_baud = 19200; break;
+				case 5: pend_baud = 38400; break;
+				default: pend_baud = 9600; break;
+			}
+			respond(res, 2);
+			break;
+		case FRAME_CMD_SET_IOM:
+			iom = arg[0];
+			respond(res, 2);
+			break;
+		case FRAME_CMD_SET_PW:
+			pw = arg[0];
+			respond(res, 2);
+			break;
+		case FRAME_CMD_RESET_IO:
+			respond(res, 2);
+			break;
+		case FRAME_CMD_SET_AL:
+			al = arg[0] ? 1 : 0;
+			al_num = n > 8 ? 7 : n-1;
+			memcpy(al_rec, arg+1, al_num);
+			memcpy(res+2, arg, n);
+			respond(res, 2+n);
+			break;
+		case FRAME_CMD_TRAIN:
+		case FRAME_CMD_SIG_TRAIN:
+			trainRecords(cmd, arg, n);
+			break;
+		case FRAME_CMD_SET_SIG:
+			if(arg[0] < 80){
+				sig_len[arg[0]] = n-1 < VR_SIG_MAX ? n-1 : VR_SIG_MAX;
+				memcpy(sig[arg[0]], arg+1, sig_len[arg[0]]);
+			}
+			memcpy(res+2, arg, n);
+			respond(res, 2+n);
+			break;
+		case FRAME_CMD_LOAD:
+			load(arg, n);
+			break;
+		case FRAME_CMD_CLEAR:
+			memset(slot, 0xFF, sizeof(slot));
+			grpm = 0xFF;
+			respond(res, 2);
+			break;
+		case FRAME_CMD_GROUP:
+			group(arg, n);
+			break;
+		case FRAME_CMD_TEST:
+			test(arg, n);
+			break;
+		default:
+			error(cmd);
+			break;
+	}
+}
+
+/** FRAME_CMD_LOAD, status of each record */
+void VRVirtualModule :: load(uint8_t *buf, uint8_t len)
+{
+	uint8_t res[2+2*255];
+	uint8_t i, k, st, cnt = 0;
+
+	grpm = 0xFF;
+	res[0] = FRAME_CMD_LOAD;
+	for(i=0; i<len; i++){
+		for(k=0; k<7 && slot[k]!=buf[i]; k++);
+		if(buf[i] >= 80){
+			st = 0xFF;
+		}else if(!trained[buf[i]]){
+			st = 0xFE;
+		}else if(k < 7){
+			st = 0xFC;
+		}else{
+			for(k=0; k<7 && slot[k]!=0xFF; k++);
+			if(k == 7){
+				st = 0xFD;
+			}else{
+				slot[k] = buf[i];
+				st = 0;
+				cnt++;
+			}
+		}
+		res[2+2*i] = buf[i];
+		res[3+2*i] = st;
+	}
+	res[1] = cnt;
+	respond(res, 2+2*len);
+}
+
+/**
+	FRAME_CMD_TRAIN/FRAME_CMD_SIG_TRAIN, two prompts for each record, each
+	after setSpeakTime(), then the status of the records.
+*/
+void VRVirtualModule :: trainRecords(uint8_t cmd, uint8_t *buf, uint8_t len)
+{
+	uint8_t res[3+255];
+	uint8_t prompt[2+sizeof(vm_speak_again)];
+	uint8_t i, n, cnt = 0, st;
+
+	n = cmd == FRAME_CMD_SIG_TRAIN ? 1 : len;
+	prompt[0] = FRAME_CMD_PROMPT;
+	for(i=0; i<n; i++){
+		prompt[1] = buf[i];
+		memcpy(prompt+2, vm_speak_now, sizeof(vm_speak_now)-1);
+		respond(prompt, 2+sizeof(vm_speak_now)-1, speak_us);
+		memcpy(prompt+2, vm_speak_again, sizeof(vm_speak_again)-1);
+		respond(prompt, 2+sizeof(vm_speak_again)-1, speak_us);
+		if(buf[i] >= 80){
+			st = 0xFF;
+		}else if(train_fail){
+			st = train_fail;
+			trained[buf[i]] = 0;
+		}else{
+			st = 0;
+			trained[buf[i]] = 1;
+			cnt++;
+		}
+		res[2+2*i] = buf[i];
+		res[3+2*i] = st;
+	}
+	train_fail = 0;
+	res[0] = cmd;
+	res[1] = cnt;
+	if(cmd == FRAME_CMD_SIG_TRAIN){
+		if(cnt){
+			sig_len[buf[0]] = len-1 < VR_SIG_MAX ? len-1 : VR_SIG_MAX;
+			memcpy(sig[buf[0]], buf+1, sig_len[buf[0]]);
+		}
+		memcpy(res+4, buf+1, len-1);
+		respond(res, 4+len-1, speak_us);
+		return;
+	}
+	respond(res, 2+2*n, speak_us);
+}
+
+/** FRAME_CMD_GROUP sub commands */
+void VRVirtualModule :: group(uint8_t *buf, uint8_t len)
+{
+	uint8_t res[12];
+	uint8_t i, g;
+
+	res[0] = FRAME_CMD_GROUP;
+	res[1] = 0;
+	switch(buf[0]){
+		case FRAME_CMD_GROUP_SET:
+			if(buf[1] == 0xFF){
+				res[2] = 0xFF;
+				res[3] = gctl;
+				respond(res, 4);
+				break;
+			}
+			gctl = buf[1];
+			respond(res, 2);
+			break;
+		case FRAME_CMD_GROUP_SUGRP:
+			memset(ugrp[buf[1]&7], 0xFF, 7);
+			memcpy(ugrp[buf[1]&7], buf+2, len-2 > 7 ? 7 : len-2);
+			respond(res, 2);
+			break;
+		case FRAME_CMD_GROUP_LSGRP:
+			for(i=0; i<7; i++){
+				slot[i] = buf[1]*7+i;
+			}
+			grpm = buf[1];
+			respond(res, 1+checkBsr(res+1, buf[1]));
+			break;
+		case FRAME_CMD_GROUP_LUGRP:
+			memcpy(slot, ugrp[buf[1]&7], 7);
+			grpm = 0x80|buf[1];
+			respond(res, 1+checkBsr(res+1, buf[1]));
+			break;
+		case FRAME_CMD_GROUP_CUGRP:
+			for(i=0; i<(len == 1 ? 8 : len-1); i++){
+				g = len == 1 ? i : buf[1+i]&7;
+				res[1] = g;
+				memcpy(res+2, ugrp[g], 7);
+				respond(res, 9);
+			}
+			break;
+		default:
+			error(FRAME_CMD_GROUP);
+			break;
+	}
+}
+
+/** FRAME_CMD_TEST, recognizer buffer read in chunks or one chunk written */
+void VRVirtualModule :: test(uint8_t *buf, uint8_t len)
+{
+	uint8_t res[2+FRAME_TEST_CHUNK_SIZE];
+	uint8_t i;
+
+	res[0] = FRAME_CMD_TEST;
+	if(buf[0] == FRAME_CMD_TEST_READ){
+		for(i=0; i<FRAME_TEST_CHUNK_NUM; i++){
+			res[1] = i;
+			memcpy(res+2, bsr+FRAME_TEST_CHUNK_SIZE*i, FRAME_TEST_CHUNK_SIZE);
+			respond(res, sizeof(res));
+		}
+		return;
+	}
+	if(len != FRAME_TEST_CHUNK_SIZE+2 || buf[1] >= FRAME_TEST_CHUNK_NUM){
+		error(FRAME_CMD_TEST);
+		return;
+	}
+	memcpy(bsr+FRAME_TEST_CHUNK_SIZE*buf[1], buf+2, FRAME_TEST_CHUNK_SIZE);
+	/** acknowledge carries no chunk index */
+	res[1] = 0;
+	respond(res, 2);
+}
+
+#endif // !ARDUINO
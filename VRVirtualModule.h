@@ -0,0 +1,187 @@
+/**
+  ******************************************************************************
+  * @file    VRVirtualModule.h
+  * @author  Elechouse Team
+  * @brief   In-memory Voice Recognition V3 module, test VRCore on a host.
+  ******************************************************************************
+    @note
+         VRVirtualModule is a transport with a virtual module behind it. It
+         parses the frames VRCore sends, keeps the module state(80 records,
+         signatures, 7 slot recognizer, system and user groups, autoload,
+         settings, recognizer buffer) and answers with the frames of a real
+         module, byte by byte on a virtual clock:
+
+           unsigned long millis() { return VRVirtualModule::millis(); }
+
+           VRVirtualModule mod;
+           VRCore myVR(&mod);
+           mod.train(0, "on");
+           myVR.begin(9600);
+           myVR.load((uint8_t)0);
+           mod.speak(0);                         // FRAME_CMD_VR of record 0
+
+         Time only moves when the library looks at it: a written byte takes
+         its wire time at the host baud rate, a response byte is ready after
+         the module turnaround plus its wire time, and every call of
+         millis(), available() or read() costs setTick() microseconds of
+         CPU. Link faults are injected on the response stream: frames
+         dropped or delayed, bytes dropped or corrupted. Host and module baud rates
+         may differ, the module then sees noise and the host reads garbage.
+         A half duplex host port(setFullDuplex(false)) garbles the response
+         bytes that arrive while it sends.
+
+         Host builds only, define millis() from the virtual clock and do not
+         link VRPosixTransport.cpp with it.
+  ******************************************************************************
+  * @section  HISTORY
+
+    2026/10/17    Initial version.
+
+  ******************************************************************************
+  */
+#ifndef __VR_VIRTUAL_MODULE_H
+#define __VR_VIRTUAL_MODULE_H
+
+#if !defined(ARDUINO)
+
+#include "VoiceRecognitionV3.h"
+
+/** bytes of module responses not read yet */
+#ifndef VR_VM_TX_SIZE
+#define VR_VM_TX_SIZE							(2048)
+#endif
+
+class VRVirtualModule : public VRTransport{
+public:
+	VRVirtualModule(unsigned long baud = 9600);
+
+	int available();
+	int read();
+	size_t write(uint8_t c);
+	int begin(unsigned long baud);
+	bool isFullDuplex() { return duplex; }
+
+	/** host port can not receive while it sends, like SoftwareSerial */
+	void setFullDuplex(bool on) { duplex = on; }
+
+	/** virtual clock, millis() costs one tick */
+	static unsigned long millis();
+	static unsigned long long micros() { return clock_us; }
+	static void advance(unsigned long us) { clock_us += us; }
+	static void setTick(unsigned long us) { tick_us = us; }
+
+	/** power cycle: new baud rate, empty recognizer, autoload */
+	void restart();
+	void setModuleBaud(unsigned long baud) { module_baud = baud; pend_baud = baud; }
+	unsigned long getModuleBaud() const { return module_baud; }
+
+	/** module delay before each response and before the prompts of training */
+	void setTurnaround(unsigned long us);
+	void setTurnaround(uint8_t cmd, unsigned long us) { cmd_us[cmd] = us; }
+	/** 0 ~ us added to each turnaround, same sequence every run */
+	void setJitter(unsigned long us) { jitter_us = us; seed = 1; }
+	void setSpeakTime(unsigned long us) { speak_us = us; }
+
+	/** records */
+	void train(uint8_t record, const char *sig = 0);
+	void untrain(uint8_t record);
+	bool isTrained(uint8_t record) const { return record < 80 && trained[record]; }
+	int getSignature(uint8_t record, uint8_t *buf) const;
+	/** status of the records of the next train command, e.g. 0xFE: timeout */
+	void failTrain(uint8_t status) { train_fail = status; }
+
+	/** recognizer */
+	uint8_t getSlot(uint8_t i) const { return slot[i]; }
+	uint8_t getGroupMode() const { return grpm; }
+	uint8_t *getRecognizerBuffer() { return bsr; }
+	/** record recognized, false if it is not in the recognizer */
+	bool speak(uint8_t record, unsigned long us = 0);
+
+	/** settings */
+	uint8_t getIOMode() const { return iom; }
+	uint8_t getPulseWidth() const { return pw; }
+	uint8_t getAutoLoad(uint8_t *records) const;
+	uint8_t getGroupControl() const { return gctl; }
+	const uint8_t *getUserGroup(uint8_t grp) const { return ugrp[grp]; }
+
+	/** faults of the response stream, count frames/bytes after skip */
+	void dropFrames(uint8_t count, uint8_t skip = 0) { fdrop_cnt = count; fdrop_skip = skip; }
+	void dropBytes(uint8_t count, uint16_t skip = 0) { bdrop_cnt = count; bdrop_skip = skip; }
+	void corruptBytes(uint8_t count, uint16_t skip = 0) { bbad_cnt = count; bbad_skip = skip; }
+	/** one response frame after skip frames comes us later, a slow module */
+	void delayFrame(unsigned long us, uint8_t skip = 0) { fdelay_us = us; fdelay_skip = skip; }
+
+	/** frames taken by the module, bytes in both directions */
+	unsigned long getFrames() const { return frames; }
+	unsigned long getHostBytes() const { return host_bytes; }
+	unsigned long getModuleBytes() const { return module_bytes; }
+	void resetStats() { frames = 0; host_bytes = 0; module_bytes = 0; }
+
+private:
+	static unsigned long long clock_us;
+	static unsigned long tick_us;
+
+	bool duplex;
+	unsigned long host_baud;
+	unsigned long module_baud;
+	unsigned long pend_baud;
+	unsigned long cmd_us[256];
+	unsigned long speak_us;
+	unsigned long jitter_us;
+	uint32_t seed;
+
+	uint8_t trained[80];
+	uint8_t sig[80][VR_SIG_MAX];
+	uint8_t sig_len[80];
+	uint8_t train_fail;
+	uint8_t slot[7];
+	uint8_t grpm;
+	uint8_t ugrp[8][7];
+	uint8_t bsr[FRAME_TEST_CHUNK_SIZE*FRAME_TEST_CHUNK_NUM];
+	uint8_t iom;
+	uint8_t pw;
+	uint8_t al;
+	uint8_t al_rec[7];
+	uint8_t al_num;
+	uint8_t gctl;
+
+	/** frame from host */
+	uint8_t rx_buf[256+2];
+	uint16_t rx_len;
+	/** response bytes and the time they are ready */
+	struct{
+		unsigned long long at;
+		uint8_t ch;
+	} tx_buf[VR_VM_TX_SIZE];
+	uint16_t tx_head;
+	uint16_t tx_cnt;
+	unsigned long long tx_last;
+
+	uint8_t fdrop_cnt;
+	uint8_t fdrop_skip;
+	uint8_t bdrop_cnt;
+	uint16_t bdrop_skip;
+	uint8_t bbad_cnt;
+	uint16_t bbad_skip;
+	unsigned long fdelay_us;
+	uint8_t fdelay_skip;
+
+	unsigned long frames;
+	unsigned long host_bytes;
+	unsigned long module_bytes;
+
+	unsigned long byteTime(unsigned long baud) const { return 10000000UL/baud; }
+	void frame(uint8_t *buf, uint8_t len);
+	void respond(const uint8_t *buf, uint8_t len, unsigned long us = 0);
+	void error(uint8_t cmd);
+	uint8_t recordStatus(uint8_t record) const;
+	uint8_t checkBsr(uint8_t *buf, uint8_t first) const;
+	void load(uint8_t *buf, uint8_t len);
+	void trainRecords(uint8_t cmd, uint8_t *buf, uint8_t len);
+	void group(uint8_t *buf, uint8_t len);
+	void test(uint8_t *buf, uint8_t len);
+};
+
+#endif // !ARDUINO
+
+#endif // __VR_VIRTUAL_MODULE_H
@@ -1,1245 +1,3819 @@
-/**
-  ******************************************************************************
-  * @file    VoiceRecognitionV2.cpp
-  * @author  Elechouse Team
-  * @version V1.0
-  * @date    2013-6-6
-  * @brief   This file provides all the VoiceRecognitionV2 firmware functions.
-  ******************************************************************************
-    @note
-         This driver is for elechouse Voice Recognition V2 Module(LINKS here)
-  ******************************************************************************
-  * @section  HISTORY
-  
-    V1.0    Initial version.
-
-  ******************************************************************************
-  * @attention
-  *
-  * THE PRESENT FIRMWARE WHICH IS FOR GUIDANCE ONLY AIMS AT PROVIDING CUSTOMERS
-  * WITH CODING INFORMATION REGARDING THEIR PRODUCTS IN ORDER FOR THEM TO SAVE
-  * TIME. AS A RESULT, ELECHOUSE SHALL NOT BE HELD LIABLE FOR ANY
-  * DIRECT, INDIRECT OR CONSEQUENTIAL DAMAGES WITH RESPECT TO ANY CLAIMS ARISING
-  * FROM THE CONTENT OF SUCH FIRMWARE AND/OR THE USE MADE BY CUSTOMERS OF THE
-  * CODING INFORMATION CONTAINED HEREIN IN CONNECTION WITH THEIR PRODUCTS.
-  *
-  * <h2><center>&copy; COPYRIGHT 2013 ELECHOUSE</center></h2>
-  ******************************************************************************
-  */
-#include "VoiceRecognitionV3.h"
-#include <string.h>
-
-VR* VR::instance;
-
-/** temp data buffer */
-uint8_t vr_buf[32];
-uint8_t hextab[17]="0123456789ABCDEF";
-
-/**
-	@brief VR class constructor.
-	@param receivePin --> software serial RX
-		   transmitPin --> software serial TX
-*/
-VR::VR(uint8_t receivePin, uint8_t transmitPin) : SoftwareSerial(receivePin, transmitPin)
-{
-	instance = this;
-	SoftwareSerial::begin(38400);
-}
-
-/**
-	@brief VR class constructor.
-	@param buf --> return data .
-			 buf[0]  -->  Group mode(FF: None Group, 0x8n: User, 0x0n:System
-             buf[1]  -->  number of record which is recognized. 
-             buf[2]  -->  Recognizer index(position) value of the recognized record.
-             buf[3]  -->  Signature length
-             buf[4]~buf[n] --> Signature
-		   timeout --> wait time for receiving packet.
-	@retval length of valid data in buf. 0 means no data received.
-*/
-int VR :: recognize(uint8_t *buf, int timeout)
-{
-	int ret, i;
-	ret = receive_pkt(vr_buf, timeout);
-	if(vr_buf[2] != FRAME_CMD_VR){
-		return -1;
-	}
-	if(ret > 0){
-		for(i = 0; i < (vr_buf[1] - 3); i++){
-			buf[i] = vr_buf[4+i];
-		} 
-		return i;
-	}
-	
-	return 0;
-}
-
-/**
-	@brief train records, at least one.
-	@param records --> record data buffer pointer.
-		   len --> number of records.
-           buf --> pointer of return value buffer, optional.
-		   buf[0]  -->  number of records which are trained successfully.
-             buf[2i+1]  -->  record number
-             buf[2i+2]  -->  record train status.
-                00 --> Trained 
-                FE --> Train Time Out
-                FF --> Value out of range"
-             (i = 0 ~ len-1 )
-	@retval '>0' --> length of valid data in buf. 
-            0 --> success, and no data received.
-            '<0' --> failed.
-                -1 --> data format error.
-                -2 --> train timeout.
-*/
-int VR :: train(uint8_t *records, uint8_t len, uint8_t *buf)
-{
-	int ret;
-	unsigned long start_millis;
-	if(len == 0){
-		return -1;
-	}
-	
-	send_pkt(FRAME_CMD_TRAIN, records, len);
-	start_millis = millis();
-	while(1){
-		ret = receive_pkt(vr_buf);
-		if(ret>0){
-			switch(vr_buf[2]){
-				case FRAME_CMD_PROMPT:
-					DBGSTR("Record:\t");
-					DBGFMT(vr_buf[3], DEC);
-					DBGSTR("\t");
-					DBGBUF(vr_buf+4, ret-4);
-					break;
-				case FRAME_CMD_TRAIN:
-					if(buf != 0){
-						memcpy(buf, vr_buf+3, vr_buf[1]-2);
-						return vr_buf[1]-2;
-					}
-					DBGSTR("Train finish.\r\nSuccess: \t");
-					DBGFMT(vr_buf[3], DEC);
-					DBGSTR(" \r\n");
-					return 0;
-					break;
-				default:
-					break;
-			}
-			start_millis = millis();
-		}
-		if(millis()-start_millis > 8000){
-			return -2;
-		}
-	}
-	return 0;
-}
-
-/**
-	@brief train one record.
-	@param records --> record data buffer pointer.
-		   len --> number of records.
-           buf --> pointer of return value buffer, optional.
-		   buf[0]  -->  number of records which are trained successfully.
-             buf[2i+1]  -->  record number
-             buf[2i+2]  -->  record train status.
-                00 --> Trained 
-                FE --> Train Time Out
-                FF --> Value out of range"
-             (i = 0 ~ len-1 )
-	@retval '>0' --> length of valid data in buf. 
-            0 --> success, and no data received.
-            '<0' --> failed.
-                -1 --> data format error.
-                -2 --> train timeout.
-*/
-int VR :: train(uint8_t record, uint8_t *buf)
-{
-    return train(&record, 1, buf);
-}
-
-/**
-	@brief train record and set a signature(alias) for this record.
-	@param record --> record value.
-           buf --> signature string/data pointer.
-		   len --> lenght of buf.
-		   retbuf --> return data .
-			 retbuf[0]  -->  number of records which are trained successfully.
-             retbuf[1]  -->  record number.
-             retbuf[2]  -->  record train status.
-                00 --> Trained 
-                F0 --> Trained, signature truncate
-                FE --> Train Time Out
-                FF --> Value out of range"
-             retbuf[3] ~ retbuf[retval-1] --> Signature.(retval means return value)
-	@retval '>0' --> length of valid data in buf. 
-            0 --> success, and no data received.
-            '<0' --> failed.
-                -1 --> data format error.
-                -2 --> train with signature timeout.
-*/
-int VR :: trainWithSignature(uint8_t record, const void *buf, uint8_t len, uint8_t * retbuf)
-{
-	int ret;
-	unsigned long start_millis;
-	if(len){
-		send_pkt(FRAME_CMD_SIG_TRAIN, record, (uint8_t *)buf, len);
-	}else{
-		if(buf == 0){
-			return -1;
-		}
-		len = strlen((char *)buf);
-		if(len>10){
-			return -1;
-		}
-		send_pkt(FRAME_CMD_SIG_TRAIN, record, (uint8_t *)buf, len);
-	}
-	
-	start_millis = millis();
-	while(1){
-		ret = receive_pkt(vr_buf);
-		if(ret>0){
-			switch(vr_buf[2]){
-				case FRAME_CMD_PROMPT:
-					DBGSTR("Record:\t");
-					DBGFMT(vr_buf[3], DEC);
-					DBGSTR("\t");
-					DBGBUF(vr_buf+4, ret-4);
-					break;
-				case FRAME_CMD_SIG_TRAIN:
-					if(retbuf != 0){
-						memcpy(retbuf, vr_buf+3, vr_buf[1]-2);
-						return vr_buf[1]-2;
-					}
-				
-					DBGSTR("Train finish.\r\nSuccess: \t");
-					DBGFMT(vr_buf[3], DEC);
-					DBGSTR(" \r\n");
-					writehex(vr_buf, vr_buf[1]+2);
-					return 0;
-					break;
-				default:
-					break;
-			}
-			start_millis = millis();
-		}
-		if(millis()-start_millis > 8000){
-			return -2;
-		}
-	}
-	return 0;
-}
-
-/**
-    @brief Load records to recognizer.
-    @param records --> record data buffer pointer.
-           len --> number of records.
-           buf --> pointer of return value buffer, optional.
-             buf[0]    -->  number of records which are load successfully.
-             buf[2i+1]  -->  record number
-             buf[2i+2]  -->  record load status.
-                00 --> Loaded 
-                FC --> Record already in recognizer
-                FD --> Recognizer full
-                FE --> Record untrained
-                FF --> Value out of range"
-             (i = 0 ~ '(retval-1)/2' )
-	@retval '>0' --> length of valid data in buf. 
-            0 --> success, buf=0, and no data returned.
-            '<0' --> failed.
-*/
-int VR :: load(uint8_t *records, uint8_t len, uint8_t *buf)
-{
-	uint8_t ret;
-	send_pkt(FRAME_CMD_LOAD, records, len);
-	ret = receive_pkt(vr_buf);
-	if(ret<=0){
-		return -1;
-	}
-	if(vr_buf[2] != FRAME_CMD_LOAD){
-		return -1;
-	}
-	if(buf != 0){
-		memcpy(buf, vr_buf+3, vr_buf[1]-2);
-		return vr_buf[1]-2;
-	}
-	return 0;
-}
-
-/**
-    @brief Load one record to recognizer.
-    @param record --> record value.
-           buf --> pointer of return value buffer, optional.
-             buf[0]    -->  number of records which are load successfully.
-             buf[2i+1]  -->  record number
-             buf[2i+2]  -->  record load status.
-                00 --> Loaded 
-                FC --> Record already in recognizer
-                FD --> Recognizer full
-                FE --> Record untrained
-                FF --> Value out of range"
-             (i = 0 ~ '(retval-1)/2' )
-	@retval '>0' --> length of valid data in buf. 
-            0 --> success, buf=0, and no data returned.
-            '<0' --> failed.
-*/
-int VR :: load(uint8_t record, uint8_t *buf)
-{
-	uint8_t ret;
-	send_pkt(FRAME_CMD_LOAD, &record, 1);
-	ret = receive_pkt(vr_buf);
-	if(ret<=0){
-		return -1;
-	}
-	if(vr_buf[2] != FRAME_CMD_LOAD){
-		return -1;
-	}
-	if(buf != 0){
-		memcpy(buf, vr_buf+3, vr_buf[1]-2);
-		return vr_buf[1]-2;
-	}
-	return 0;
-}
-
-/**
-    @brief set signature(alias) for a record.
-    @param record --> record value.
-           buf --> signature buffer.
-           len --> length of buf.
-    @retval 0 --> success, buf=0, and no data returned.
-            '<0' --> failed.
-*/
-int VR :: setSignature(uint8_t record, const void *buf, uint8_t len)
-{
-	int ret;
-	
-	if(len == 0 && buf == 0){
-		/** delete signature */
-	}else if(len == 0 && buf != 0){
-		if(buf == 0){
-			return -1;
-		}
-		len = strlen((char *)buf);
-		if(len>10){
-			return -1;
-		}
-	}else if(len != 0 && buf != 0){
-		
-	}else{
-		return -1;
-	}
-	send_pkt(FRAME_CMD_SET_SIG, record, (uint8_t *)buf, len);
-	ret = receive_pkt(vr_buf);
-	if(ret<=0){
-		return -1;
-	}
-	if(vr_buf[2] != FRAME_CMD_SET_SIG){
-		return -1;
-	}
-	return 0;
-}
-
-/**
-    @brief delete signature(alias) of a record.
-    @param record --> record value.
-    @retval  0 --> success
-            -1 --> failed
-*/
-int VR :: deleteSignature(uint8_t record)
-{
-    return setSignature(record);
-}
-
-/**
-    @brief check the signature(alias) of a record.
-    @param record --> record value.
-           buf --> signature, return value buffer.
-    @retval '>0' --> length of valid data in buf. 
-            0 --> success, buf=0, and no data returned.
-            '<0' --> failed.
-*/
-int VR :: checkSignature(uint8_t record, uint8_t *buf)
-{
-	int ret;
-	if(record < 0){
-		return -1;
-	}
-	send_pkt(FRAME_CMD_CHECK_SIG, record, 0, 0);
-	ret = receive_pkt(vr_buf);
-	
-	if(ret<=0){
-		return -1;
-	}
-	if(vr_buf[2] != FRAME_CMD_CHECK_SIG){
-		return -1;
-	}
-
-	if(vr_buf[4]>0){
-		memcpy(buf, vr_buf+5, vr_buf[4]);
-		return vr_buf[4];
-	}else{
-		return 0;
-	}
-}
-
-/**
-    @brief clear recognizer.
-    @retval  0 --> success
-            -1 --> failed
-*/
-int VR :: clear()
-{	
-	int len;
-	send_pkt(FRAME_CMD_CLEAR, 0, 0);
-	len = receive_pkt(vr_buf);
-	if(len<=0){
-		return -1;
-	}
-
-	if(vr_buf[2] != FRAME_CMD_CLEAR){
-		return -1;
-	}
-	//DBGLN("VR Module Cleared");
-	return 0;
-}
-
-/**
-    @brief clear recognizer.
-    @param buf --> return value buffer.
-             buf[0]     -->  Number of valid voice records in recognizer
-             buf[i+1]   -->  Record number.(0xFF: Not loaded(Nongroup mode), or not set (Group mode)) 
-                (i= 0, 1, ... 6)
-             buf[8]     -->  Number of all voice records in recognizer
-             buf[9]     -->  Valid records position indicate.
-             buf[10]    -->  Group mode indicate(FF: None Group, 0x8n: User, 0x0n:System
-    @retval '>0' --> success, length of data in buf 
-            -1 --> failed
-*/
-int VR :: checkRecognizer(uint8_t *buf)
-{
-	int len;
-	send_pkt(FRAME_CMD_CHECK_BSR, 0, 0);
-	len = receive_pkt(vr_buf);
-	if(len<=0){
-		return -1;
-	}
-
-	if(vr_buf[2] != FRAME_CMD_CHECK_BSR){
-		return -1;
-	}
-	
-	if(vr_buf[1] != 0x0D){
-		return -1;
-	}
-	
-	memcpy(buf, vr_buf+3, vr_buf[1]-2);
-	
-	return vr_buf[1]-2;
-}
-
-/**
-    @brief check record train status.
-    @param buf --> return value
-             buf[0]     -->  Number of checked records
-             buf[2i+1]  -->  Record number.
-             buf[2i+2]  -->  Record train status. (00: untrained, 01: trained, FF: record value out of range)
-             (i = 0 ~ buf[0]-1 )
-    @retval Number of trained records
-*/
-int VR :: checkRecord(uint8_t *buf, uint8_t *records, uint8_t len)
-{
-	int ret;
-	int cnt = 0;
-	unsigned long start_millis;
-	if(records == 0 && len==0){
-        memset(buf, 0xF0, 255);
-		send_pkt(FRAME_CMD_CHECK_TRAIN, 0xFF, 0, 0);
-		start_millis = millis();
-		while(1){
-			len = receive_pkt(vr_buf);
-			if(len>0){
-				if(vr_buf[2] == FRAME_CMD_CHECK_TRAIN){
-                    for(int i=0; i<vr_buf[1]-3; i+=2){
-                        buf[vr_buf[4+i]]=vr_buf[4+i+1];
-                    }
-					cnt++;
-					if(cnt == 51){
-						return vr_buf[3];
-					}
-				}else{
-					return -3;
-				}
-				start_millis = millis();
-			}
-			
-			if(millis()-start_millis > 500){
-				if(cnt>0){
-					buf[0] = cnt*5;
-					return vr_buf[3];
-				}
-				return -2;
-			}
-			
-		}
-		
-	}else if(len>0){
-		ret = cleanDup(vr_buf, records, len);
-		send_pkt(FRAME_CMD_CHECK_TRAIN, vr_buf, ret);
-		ret = receive_pkt(vr_buf);
-		if(ret>0){
-			if(vr_buf[2] == FRAME_CMD_CHECK_TRAIN){
-				memcpy(buf+1, vr_buf+4, vr_buf[1]-3);
-				buf[0] = (vr_buf[1]-3)/2;
-				return vr_buf[3];
-			}else{
-				return -3;
-			}
-		}else{
-			return -1;
-		}
-	}else{
-		return -1;
-	}
-	
-}
-
-/****************************************************************************/
-/******************************* GROUP CONTROL ******************************/
-/**
-    @brief set group control by external IO function
-    @param ctrl --> group control by external IO
-                0 --> disable group control by external IO
-                1 --> user group control by external IO
-                2 --> system group control by external IO
-    @retval  0 --> success
-            -1 --> failed
-*/
-int VR :: setGroupControl(uint8_t ctrl)
-{
-	int ret;
-	if(ctrl>2){
-		return -1;
-	}
-	
-	send_pkt(FRAME_CMD_GROUP, FRAME_CMD_GROUP_SET, &ctrl, 1);
-	ret = receive_pkt(vr_buf);
-	if(ret<=0){
-		return -1;
-	}
-
-	if(vr_buf[2] != FRAME_CMD_GROUP){
-		return -1;
-	}
-	return 0;
-}
-
-/**
-    @brief check group control by external IO function
-    @param ctrl --> group control by external IO
-    @retval  0 --> group control by external IO disabled
-             1 --> user group control by external IO status
-             2 --> system group control by external IO status
-            -1 --> failed
-*/
-int VR :: checkGroupControl()
-{
-	uint8_t cmd;
-	int ret;
-	cmd = 0xFF;
-	send_pkt(FRAME_CMD_GROUP, FRAME_CMD_GROUP_SET, &cmd, 1);
-	ret = receive_pkt(vr_buf);
-	if(ret<=0){
-		return -1;
-	}
-
-	if(vr_buf[2] != FRAME_CMD_GROUP){
-		return -1;
-	}
-	ret = vr_buf[5];
-	if(ret == 0xFF){
-		ret = 0;
-	}
-	return ret;
-}
-
-/**
-    @brief set user gruop content.
-    @param grp --> user group number.
-           records --> pointer of records buffer.
-           len --> length of reocrds
-    @retval  0 --> success
-            -1 --> failed
-*/
-int VR :: setUserGroup(uint8_t grp, uint8_t *records, uint8_t len)
-{
-	int ret;
-	if(len == 0 || records == 0){
-		return -1;
-	}
-	if(grp >= 8){
-		return -1;
-	}
-	vr_buf[0] = grp;
-	memcpy(vr_buf+1, records, len);
-	send_pkt(FRAME_CMD_GROUP, FRAME_CMD_GROUP_SUGRP, vr_buf, len+1);
-	ret = receive_pkt(vr_buf);
-	if(ret<=0){
-		return -1;
-	}
-	if(vr_buf[2] != FRAME_CMD_GROUP){
-		return -1;
-	}
-	return 0;
-}
-
-/**
-    @brief check user gruop content.
-    @param grp --> user group number.
-           buf --> return value
-             buf[8i]    -->  group number.
-             buf[8i+1]  -->  group position 0 status.
-             buf[8i+2]  -->  group position 1 status.
-               ...                ...
-             buf[8i+6]  -->  group position 5 status.
-             buf[8i+7]  -->  group position 6 status.
-             (i = 0 ~ @retval)
-    @retval '>0' --> number of checked user group
-            '<0' --> failed
-*/
-int VR :: checkUserGroup(uint8_t grp, uint8_t *buf)
-{
-	int ret;
-	int cnt = 0;
-	unsigned long start_millis;
-	
-	if(grp == GROUP_ALL){
-		send_pkt(FRAME_CMD_GROUP, FRAME_CMD_GROUP_CUGRP, 0, 0);
-		start_millis = millis();
-		while(1){
-			ret = receive_pkt(vr_buf);
-			if(ret>0){
-				if(vr_buf[2] == FRAME_CMD_GROUP && vr_buf[1] == 10){
-					memcpy(buf+8*cnt, vr_buf+3, vr_buf[1]-2);
-					cnt++;
-					if(cnt == 8){
-						return cnt;
-					}
-				}else{
-					return -3;
-				}
-				start_millis = millis();
-			}
-			
-			if(millis()-start_millis > 500){
-				if(cnt>0){
-					return cnt;
-				}
-				return -2;
-			}
-			
-		}
-	}else if(grp <= GROUP7){
-		send_pkt(FRAME_CMD_GROUP, FRAME_CMD_GROUP_CUGRP, &grp, 1);
-		ret = receive_pkt(vr_buf);
-		if(ret>0){
-			if(vr_buf[2] == FRAME_CMD_GROUP && vr_buf[1] == 10){
-				memcpy(buf+8*cnt, vr_buf+3, vr_buf[1]-2);
-				return 1;
-			}else{
-				return -3;
-			}
-		}else{
-			return -2;
-		}
-	}else{
-		return -1;
-	}
-}
-
-/**
-    @brief load system gruop content to recognizer.
-    @param grp --> syestem group number.
-           buf  -->  return value.
-             buf[0]     -->  Number of valid voice records in recognizer.
-             buf[i+1]   -->  Record number.(0xFF: Not loaded(Nongroup mode), or not set (Group mode)) 
-                (i= 0, 1, ... 6)
-             buf[8]     -->  Number of all voice records in recognizer
-             buf[9]     -->  Valid records position indicate.
-             buf[10]    -->  Group mode indicate(FF: None Group, 0x8n: User, 0x0n:System
-             (i = 0 ~ @retval)
-    @retval '>0' --> length of buf
-            '<0' --> failed
-*/
-int VR :: loadSystemGroup(uint8_t grp, uint8_t *buf)
-{
-	int ret;
-	if(grp > 10){
-		return -1;
-	}
-	send_pkt(FRAME_CMD_GROUP, FRAME_CMD_GROUP_LSGRP, &grp, 1);
-	ret = receive_pkt(vr_buf);
-	
-	if(ret <= 0){
-		return -1;
-	}
-	
-	if(vr_buf[2] != FRAME_CMD_GROUP){
-		return -1;
-	}
-	
-	if(buf != 0){
-		vr_buf[3] = 0;
-		for(int i=0; i<8; i++){
-			if(vr_buf[12]&(1<<i)){
-				vr_buf[3]++;
-			}
-		}
-		memcpy(buf, vr_buf+3, vr_buf[1]-2);
-		return vr_buf[1]-2;
-	}
-	
-	return 0;
-}
-
-/**
-    @brief load user gruop content to recognizer.
-    @param grp --> user group number.
-           buf  -->  return value.
-             buf[0]     -->  Number of valid voice records in recognizer.
-             buf[i+1]   -->  Record number.(0xFF: Not loaded(Nongroup mode), or not set (Group mode)) 
-                (i= 0, 1, ... 6)
-             buf[8]     -->  Number of all voice records in recognizer
-             buf[9]     -->  Valid records position indicate.
-             buf[10]    -->  Group mode indicate(FF: None Group, 0x8n: User, 0x0n:System)
-             (i = 0 ~ @retval)
-    @retval '>0' --> length of buf
-            '<0' --> failed
-*/
-int VR :: loadUserGroup(uint8_t grp, uint8_t *buf)
-{
-	int ret;
-	if(grp > GROUP7){
-		return -1;
-	}
-	send_pkt(FRAME_CMD_GROUP, FRAME_CMD_GROUP_LUGRP, &grp, 1);
-	ret = receive_pkt(vr_buf);
-	
-	if(ret <= 0){
-		return -1;
-	}
-	
-	if(vr_buf[2] != FRAME_CMD_GROUP){
-		return -1;
-	}
-	
-	if(buf != 0){
-		vr_buf[3] = 0;
-		for(int i=0; i<8; i++){
-			if(vr_buf[12]&(1<<i)){
-				vr_buf[3]++;
-			}
-		}
-		memcpy(buf, vr_buf+3, 11);
-		return 1;
-	}
-	
-	return 0;
-}
-
-/**
-    @brief reset system setting to default
-    @retval  0 --> success
-            -1 --> failed
-*/
-int VR :: restoreSystemSettings()
-{
-	int len;
-	send_pkt(FRAME_CMD_RESET_DEFAULT, 0, 0);
-	len = receive_pkt(vr_buf);
-	if(len<=0){
-		return -1;
-	}
-
-	if(vr_buf[2] != FRAME_CMD_RESET_DEFAULT){
-		return -1;
-	}
-
-	return 0;
-}
-
-/**
-    @brief check system settings
-    @param buf --> return value
-            buf[0] --> baud rate. (0-9600 1-2400 2-4800 3-9600 4-19200 5-38400)
-            buf[1] --> output io mode(0-pulse 1-toggle 2-clear 3-set)
-            buf[2] --> pulse width level
-            buf[3] --> auto load(0,0xFF-disable 1-enable)
-            buf[4] --> Group control by external IO(0-disable 1-system group 2-user group)
-    @retval '>0' --> buf length
-            -1 --> failed
-*/
-int VR :: checkSystemSettings(uint8_t* buf)
-{
-	int len;
-	if(buf == 0){
-		return -1;
-	}
-	send_pkt(FRAME_CMD_CHECK_SYSTEM, 0, 0);
-	len = receive_pkt(vr_buf);
-	if(len<=0){
-		return -1;
-	}
-	
-	if(vr_buf[2] != FRAME_CMD_CHECK_SYSTEM){
-		return -1;
-	}
-
-	memcpy(buf, vr_buf+4, vr_buf[1]-3);
-	return vr_buf[1]-3;
-
-	return 0;
-}
-
-/**
-    @brief set module baud rate.
-    @param br --> module baud rate.(0-9600 1-2400 2-4800 3-9600 4-19200 5-38400)
-    @retval 0 --> success
-            -1 --> failed
-*/
-int VR :: setBaudRate(unsigned long br)
-{
-	uint8_t baud_rate;
-	int ret;
-	switch(br){
-		case 2400:
-			baud_rate = 1;
-			break;
-		case 4800:
-			baud_rate = 2;
-			break;
-		case 9600:
-			baud_rate = 0;
-			//baud_rate = 3;
-			break;
-		case 19200:
-			baud_rate = 4;
-			break;
-		case 38400:
-			baud_rate = 5;
-			break;
-		default:
-			return -1;
-			break;
-	}
-	
-	send_pkt(FRAME_CMD_SET_BR, baud_rate, 0, 0);
-	ret = receive_pkt(vr_buf);
-	if(ret<=0){
-		return -1;
-	}
-
-	if(vr_buf[2] != FRAME_CMD_SET_BR){
-		return -1;
-	}
-	//DBGLN("VR Module Cleared");
-	return 0;
-	
-}
-
-/**
-    @brief set module output IO mode.
-    @param mode --> module output IO mode.(must be PULSE, TOGGLE, SET, CLEAR)
-    @retval 0 --> success
-            -1 --> failed
-*/
-int VR :: setIOMode(io_mode_t mode)
-{
-	if(mode > 3){
-		return -1;
-	}
-	int ret;
-	
-	send_pkt(FRAME_CMD_SET_IOM, mode, 0, 0);
-	ret = receive_pkt(vr_buf);
-	if(ret<=0){
-		return -1;
-	}
-
-	if(vr_buf[2] != FRAME_CMD_SET_IOM){
-		return -1;
-	}
-	return 0;
-}
-
-/**
-    @brief resset module output IO.
-    @param ios --> output IO buffer.
-           len --> length of ios.
-    @retval 0 --> success
-            -1 --> failed
-*/
-int VR :: resetIO(uint8_t *ios, uint8_t len)
-{
-	int ret;
-	if(len == 1 && ios == 0){
-		send_pkt(FRAME_CMD_RESET_IO, 0xFF, 0, 0);
-	}else if(len != 0 && ios != 0){
-		send_pkt(FRAME_CMD_RESET_IO, ios, len);
-	}else{
-		return -1;
-	}
-
-	ret = receive_pkt(vr_buf);
-	if(ret<=0){
-		return -1;
-	}
-	if(vr_buf[2] != FRAME_CMD_RESET_IO){
-		return -1;
-	}
-	return 0;
-}
-
-/**
-    @brief set module pulse width(PULSE mode).
-    @param level --> pulse width level.(LEVEL0~LEVEL15)
-           len --> length of ios.
-    @retval 0 --> success
-            -1 --> failed
-*/
-int VR :: setPulseWidth(uint8_t level)
-{
-	int ret;
-	
-	if(level > VR::LEVEL15){
-		return -1;
-	}
-	
-	send_pkt(FRAME_CMD_SET_PW, level, 0, 0);
-	ret = receive_pkt(vr_buf);
-	if(ret<=0){
-		return -1;
-	}
-
-	if(vr_buf[2] != FRAME_CMD_SET_PW){
-		return -1;
-	}
-	return 0;
-}
-
-/**
-    @brief set autoload.
-    @param records --> record buffer.
-           len --> records length.
-    @retval 0 --> success
-            -1 --> failed
-*/
-int VR :: setAutoLoad(uint8_t *records, uint8_t len)
-{
-	int ret;
-	uint8_t map;
-	if(len == 0 && records == 0){
-		map = 0;
-	}else if(len != 0 && records != 0){
-		map = 0;
-		for(int i=0; i<len; i++){
-			map |= (1<<i);
-		}
-	}else{
-		return -1;
-	}
-	
-	send_pkt(FRAME_CMD_SET_AL, map, records, len);
-	ret = receive_pkt(vr_buf);
-	if(ret<=0){
-		return -1;
-	}
-	if(vr_buf[2] != FRAME_CMD_SET_AL){
-		return -1;
-	}
-	return 0;
-}
-
-/**
-    @brief disable autoload.
-    @param records --> record buffer.
-           len --> records length.
-    @retval 0 --> success
-            -1 --> failed
-*/
-int VR :: disableAutoLoad()
-{
-    return setAutoLoad();
-}
-
-int VR :: test(uint8_t cmd, uint8_t *bsr)
-{
-	int len, i;
-	unsigned long start_millis;
-	switch(cmd){
-		case FRAME_CMD_TEST_READ:
-			vr_buf[0] = FRAME_CMD_TEST_READ;
-			send_pkt(FRAME_CMD_TEST, vr_buf, 1);
-			start_millis = millis();
-			while(1){
-				len = receive_pkt(vr_buf);
-				if(len>0){
-					switch(vr_buf[2]){
-						case FRAME_CMD_TEST:
-							memcpy(bsr+vr_buf[3]*20, vr_buf+4, 20);
-							if(vr_buf[3] == 9){
-								return 0;
-							}
-							break;
-						default:
-							DBGLN("TEST ERROR");
-							return -1;
-							break;
-					}
-					start_millis = millis();
-				}
-				if(millis()-start_millis > 4000){
-					return -2;
-				}
-			}
-			break;
-		case FRAME_CMD_TEST_WRITE:
-			for(i=0; i<10; i++){
-				vr_buf[0] = i;
-				memcpy(vr_buf+1, bsr+20*i, 20);
-				send_pkt(FRAME_CMD_TEST, FRAME_CMD_TEST_WRITE, vr_buf, 21);
-				start_millis = millis();
-				while(1){
-					len = receive_pkt(vr_buf);
-					if(len>0){
-						if(vr_buf[2] == FRAME_CMD_TEST){
-							break;
-						}else{
-							DBGLN("TEST ERROR");
-							return -1;
-						}
-						start_millis = millis();
-					}
-					if(millis()-start_millis > 4000){
-						return -2;
-					}
-				}
-			}
-			break;
-		default:
-			break;
-	}
-	return 0;
-}
-
-/**flash operation function (strlen)*/
-int VR :: len(uint8_t *buf)
-{
-	int i=0;
-	while(pgm_read_byte_near(buf++)){
-		i++;
-	}
-	return i;
-}
-
-/**flash operation function (strcmp)*/
-int VR :: cmp(uint8_t *buf, uint8_t *bufcmp, int len  )
-{
-	int i;
-	for(i=0; i<len; i++){
-		if(buf[i] != pgm_read_byte_near(bufcmp+i)){
-			return -1;
-		}
-	}
-	return 0;
-}
-
-/**flash operation function (strcpy)*/
-void VR :: cpy(char *buf, char * pbuf)
-{
-  int i=0;
-  while(pgm_read_byte_near(pbuf)){
-    buf[i] = pgm_read_byte_near(pbuf++);
-    i++;
-  }
-}
-
-/** ascending sort */
-void VR :: sort(uint8_t *buf, int len)
-{
-	int i, j;
-	uint8_t tmp;
-	for(i=0; i<len; i++){
-		for(j=i+1; j<len; j++){
-			if(buf[j] < buf[i]){
-				tmp = buf[i];
-				buf[i] = buf[j]; 
-				buf[j] = tmp;
-			}
-		}
-	}
-}
-
-/** remove duplicates */
-int VR :: cleanDup(uint8_t *des, uint8_t *buf, int len)
-{	
-	if(len<1){
-		return -1;
-	}
-	
-	int i, j, k=0;
-	for(i=0; i<len; i++){
-		for(j=0; j<k; j++){
-			if(buf[i] == des[j]){
-				break;
-			}
-		}
-		if(j==k){
-			des[k] = buf[i];
-			k++;
-		}
-	}
-	return k;
-#if 0
-	int i=0, j=1, k=0;
-	sort(buf, len);
-	for(; j<len; ){
-		des[k] = buf[i];
-		k++;
-		while(buf[i]==buf[j]){
-			j++;
-			if(j==len){
-				return k;
-			}
-		}
-		i=j;
-	}
-	return k;
-#endif
-}
-
-/** Serial print in HEX format */
-int VR :: writehex(uint8_t *buf, uint8_t len)
-{
-	int i;
-	for(i=0; i<len; i++){
-		DBGCHAR(hextab[(buf[i]&0xF0)>>4]);
-		DBGCHAR(hextab[(buf[i]&0x0F)]);
-		DBGCHAR(' ');
-	}
-	return len;
-}
-
-/**
-    @brief send data packet in Voice Recognition module protocol format.
-    @param cmd --> command 
-           subcmd --> subcommand
-           buf --> data area
-           len --> length of buf
-*/
-void VR :: send_pkt(uint8_t cmd, uint8_t subcmd, uint8_t *buf, uint8_t len)
-{
-	while(available()){
-		read();// replace flush();
-	}
-	write(FRAME_HEAD);
-	write(len+3);
-	write(cmd);
-	write(subcmd);
-	write(buf, len);
-	write(FRAME_END);
-}
-
-/**
-    @brief send data packet in Voice Recognition module protocol format.
-    @param cmd --> command 
-           buf --> data area
-           len --> length of buf
-*/
-void VR :: send_pkt(uint8_t cmd, uint8_t *buf, uint8_t len)
-{
-	while(available()){
-		read();// replace flush();
-	}
-	write(FRAME_HEAD);
-	write(len+2);
-	write(cmd);
-	write(buf, len);
-	write(FRAME_END);
-}
-
-/**
-    @brief send data packet in Voice Recognition module protocol format.
-    @param buf --> data area
-           len --> length of buf
-*/
-void VR :: send_pkt(uint8_t *buf, uint8_t len)
-{
-	while(available()){
-		read();// replace flush();
-	}
-	write(FRAME_HEAD);
-	write(len+1);
-	write(buf, len);
-	write(FRAME_END);
-}
-
-/**
-    @brief receive a valid data packet in Voice Recognition module protocol format.
-    @param buf --> return value buffer.
-           timeout --> time of reveiving
-    @retval '>0' --> success, packet lenght(length of all data in buf)
-            '<0' --> failed
-*/
-int VR :: receive_pkt(uint8_t *buf, uint16_t timeout)
-{
-	int ret;
-	ret = receive(buf, 2, timeout);
-	if(ret != 2){
-		return -1;
-	}
-	if(buf[0] != FRAME_HEAD){
-		return -2;
-	}
-	if(buf[1] < 2){
-		return -3;
-	}
-	ret = receive(buf+2, buf[1], timeout);
-	if(buf[buf[1]+1] != FRAME_END){
-		return -4;
-	}
-	
-//	DBGBUF(buf, buf[1]+2);
-	
-	return buf[1]+2;
-}
-
-/**
-    @brief receive data .
-    @param buf --> return value buffer.
-           len --> length expect to receive.
-           timeout --> time of reveiving
-    @retval number of received bytes, 0 means no data received.
-*/
-int VR::receive(uint8_t *buf, int len, uint16_t timeout)
-{
-  int read_bytes = 0;
-  int ret;
-  unsigned long start_millis;
-  
-  while (read_bytes < len) {
-    start_millis = millis();
-    do {
-      ret = read();
-      if (ret >= 0) {
-        break;
-     }
-    } while( (millis()- start_millis ) < timeout);
-    
-    if (ret < 0) {
-      return read_bytes;
-    }
-    buf[read_bytes] = (char)ret;
-    read_bytes++;
-  }
-  
-  return read_bytes;
-}
+/**
+  ******************************************************************************
+  * @file    VoiceRecognitionV2.cpp
+  * @author  Elechouse Team
+  * @version V1.0
+  * @date    2013-6-6
+  * @brief   This file provides all the VoiceRecognitionV2 firmware functions.
+  ******************************************************************************
+    @note
+         This driver is for elechouse Voice Recognition V2 Module(LINKS here)
+  ******************************************************************************
+  * @section  HISTORY
+  
+    V1.0    Initial version.
+
+  ******************************************************************************
+  * @attention
+  *
+  * THE PRESENT FIRMWARE WHICH IS FOR GUIDANCE ONLY AIMS AT PROVIDING CUSTOMERS
+  * WITH CODING INFORMATION REGARDING THEIR PRODUCTS IN ORDER FOR THEM TO SAVE
+  * TIME. AS A RESULT, ELECHOUSE SHALL NOT BE HELD LIABLE FOR ANY
+  * DIRECT, INDIRECT OR CONSEQUENTIAL DAMAGES WITH RESPECT TO ANY CLAIMS ARISING
+  * FROM THE CONTENT OF SUCH FIRMWARE AND/OR THE USE MADE BY CUSTOMERS OF THE
+  * CODING INFORMATION CONTAINED HEREIN IN CONNECTION WITH THEIR PRODUCTS.
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 ELECHOUSE</center></h2>
+  ******************************************************************************
+  */
+#include "VoiceRecognitionV3.h"
+#include <string.h>
+
+const uint8_t hextab[17] PROGMEM = "0123456789ABCDEF";
+/** module baud rates, factory default first */
+const uint32_t vr_baud_tab[5] PROGMEM = {
+	9600, 2400, 4800, 19200, 38400
+};
+
+#if VR_ENABLE_ASYNC
+const uint8_t vr_profile_head[VR_PROFILE_HEAD] PROGMEM = {
+	VR_PROFILE_BEGIN
+};
+#endif
+
+/**
+	@brief VRCore class constructor.
+	@param port --> byte transport connected to the module.
+*/
+VRCore::VRCore(VRTransport *port) : port(port)
+{
+	baud = 0;
+	last_baud = 0;
+	rx_cnt = 0;
+	rx_pend = 0;
+	rx_done = 0;
+	rx_lost = 0;
+	rx_millis = 0;
+	resetLinkStats();
+#if VR_ENABLE_ASYNC
+	cmdq_head = 0;
+	cmdq_cnt = 0;
+	cmdq_seq = 0;
+	cmdq_depth = 1;
+	batch_on = 0;
+	batch_size = 0;
+	batch_fail = 0;
+	batch_status = 0;
+	vr_cb = 0;
+	vr_cb_arg = 0;
+#endif
+#if VR_ENABLE_TRAIN
+	prompt_cb = 0;
+	prompt_cb_arg = 0;
+#endif
+	clearTrace();
+	rto_valid = 0;
+	rto_min = VR_RTO_MIN;
+	rto_max = VR_RTO_MAX;
+	tx_cmd = 0;
+	tx_len = 0;
+	rto_wait = 0;
+	rto_lost = 0;
+	tx_millis = 0;
+	invalidateRecognizer();
+#if VR_ENABLE_SIG_CACHE
+	sig_on = 0;
+#if !(defined(ARDUINO) && defined(__AVR__))
+	memset(sig_mem, 0xFF, sizeof(sig_mem));
+#endif
+#endif
+}
+
+/**
+	@brief set link speed, must match module baud rate.
+	@param baud --> 2400, 4800, 9600, 19200, 38400
+	@retval 0 --> success
+	        -1 --> transport refused the rate, e.g. not supported by the tty
+*/
+int VRCore :: begin(unsigned long baud)
+{
+	if(port->begin(baud) < 0){
+		return -1;
+	}
+	this->baud = baud;
+	return 0;
+}
+
+#if defined(ARDUINO)
+VR* VR::instances[VR_MAX_INSTANCES];
+uint8_t VR::instance_cnt;
+
+/**
+	@brief VR class constructor.
+	@param receivePin --> software serial RX
+		   transmitPin --> software serial TX
+*/
+VR::VR(uint8_t receivePin, uint8_t transmitPin) : SoftwareSerial(receivePin, transmitPin), 
+	VRCore(&link), link(*this)
+{
+	if(instance_cnt < VR_MAX_INSTANCES){
+		instances[instance_cnt++] = this;
+	}
+	begin(38400);
+}
+
+/**
+	@brief VR class destructor, remove the instance from registry.
+*/
+VR::~VR()
+{
+	uint8_t i;
+	for(i=0; i<instance_cnt; i++){
+		if(instances[i] == this){
+			break;
+		}
+	}
+	if(i == instance_cnt){
+		return;
+	}
+	instance_cnt--;
+	for(; i<instance_cnt; i++){
+		instances[i] = instances[i+1];
+	}
+}
+
+/**
+	@brief set SoftwareSerial baud rate, must match module baud rate.
+*/
+void VR :: begin(long speed)
+{
+	VRCore::begin(speed);
+}
+
+#if VR_ENABLE_ASYNC
+/****************************************************************************/
+/******************************** SCHEDULER *********************************/
+/**
+	@brief VRScheduler class constructor.
+	@param window --> listen window of each module, ms.
+*/
+VRScheduler::VRScheduler(uint16_t window) : window(window)
+{
+	cur = 0;
+	start_millis = 0;
+	resetStats();
+}
+
+/**
+	@brief set listen window of each module.
+	@param window --> ms
+*/
+void VRScheduler :: setWindow(uint16_t window)
+{
+	this->window = window;
+}
+
+/**
+	@brief drive all registered modules, call it in loop(). Runs process() of 
+           every module and moves the listen window to the next module when 
+           the window is over and the line is idle.
+	@retval index of the listening module, -1 if no module is registered.
+*/
+int VRScheduler :: run()
+{
+	uint8_t i, n;
+	unsigned long now;
+	VR *vr;
+	
+	n = VR::getInstanceCount();
+	if(n == 0){
+		return -1;
+	}
+	if(cur >= n){
+		cur = 0;
+	}
+	
+	vr = VR::getInstance(cur);
+	now = millis();
+	if(!vr->isListening()){
+		select(cur, now);
+	}
+	
+	for(i=0; i<n; i++){
+		VR::getInstance(i)->process();
+	}
+	
+	now = millis();
+	if(n > 1 && now - start_millis >= window && !vr->isBusy()){
+		dwell[cur] += now - start_millis;
+		left_millis[cur] = now;
+		select((cur+1)%n, now);
+	}
+	
+	return cur;
+}
+
+/** give the line to module index */
+void VRScheduler :: select(uint8_t index, unsigned long now)
+{
+	unsigned long wait, nominal;
+	uint8_t n = VR::getInstanceCount();
+	
+	if(left_millis[index] != 0){
+		/** module waited longer than one turn of the other modules */
+		wait = now - left_millis[index];
+		nominal = (unsigned long)window*(n-1);
+		if(wait > nominal){
+			missed[index] += (wait - nominal)/window;
+		}
+	}
+	cur = index;
+	start_millis = now;
+	VR::getInstance(index)->listen();
+}
+
+/**
+	@brief listening module.
+*/
+VR *VRScheduler :: current()
+{
+	return VR::getInstance(cur);
+}
+
+/**
+	@brief total listening time of module index(registry order), ms.
+*/
+unsigned long VRScheduler :: getDwell(uint8_t index)
+{
+	return index < VR_MAX_INSTANCES ? dwell[index] : 0;
+}
+
+/**
+	@brief number of listen windows module index(registry order) lost, 
+           because another module held the line.
+*/
+unsigned long VRScheduler :: getMissed(uint8_t index)
+{
+	return index < VR_MAX_INSTANCES ? missed[index] : 0;
+}
+
+/**
+	@brief clear dwell time and missed window counts.
+*/
+void VRScheduler :: resetStats()
+{
+	uint8_t i;
+	for(i=0; i<VR_MAX_INSTANCES; i++){
+		dwell[i] = 0;
+		left_millis[i] = 0;
+		missed[i] = 0;
+	}
+}
+#endif
+#endif
+
+/**
+	@brief VR class constructor.
+	@param buf --> return data .
+			 buf[0]  -->  Group mode(FF: None Group, 0x8n: User, 0x0n:System
+             buf[1]  -->  number of record which is recognized. 
+             buf[2]  -->  Recognizer index(position) value of the recognized record.
+             buf[3]  -->  Signature length
+             buf[4]~buf[n] --> Signature, from signature cache when the 
+                               module sends none.
+		   timeout --> wait time for receiving packet, 0 means only take the 
+                       bytes already received and return at once.
+	@retval length of valid data in buf. 0 means no data received.
+*/
+int VRCore :: recognize(uint8_t *buf, int timeout)
+{
+	int ret, i;
+	RecognitionResult res;
+	ret = recognize(res, timeout);
+	if(ret > 0){
+		for(i = 0; i < (vr_buf[1] - 3); i++){
+			buf[i] = vr_buf[4+i];
+		} 
+#if VR_ENABLE_SIG_CACHE
+		if(buf[3] == 0 && (ret = sigFetch(buf[1], buf+4)) > 0){
+			buf[3] = ret;
+			i = 4 + ret;
+		}
+#endif
+		return i;
+	}
+	
+	return ret;
+}
+
+/**
+	@brief receive a voice recognized frame without copying it.
+	@param res --> result view, points into the receive buffer, valid until 
+                   the next poll().
+		   timeout --> wait time for receiving packet, 0 means only take the 
+                       bytes already received and return at once.
+	@retval '>0' --> voice recognized, frame length. 
+            0 --> no data received.
+            -1 --> other frame received, or receive error.
+*/
+int VRCore :: recognize(RecognitionResult &res, int timeout)
+{
+	int ret;
+	res = RecognitionResult();
+	ret = receive_pkt(vr_buf, timeout);
+	if(ret <= 0){
+		return ret == -1 ? 0 : -1;
+	}
+	if(vr_buf[2] != FRAME_CMD_VR || vr_buf[1] < 7){
+		return -1;
+	}
+	res = RecognitionResult(vr_buf);
+	return ret;
+}
+
+#if VR_ENABLE_TRAIN
+/**
+	@brief train records, at least one.
+	@param records --> record data buffer pointer.
+		   len --> number of records.
+           buf --> pointer of return value buffer, optional.
+		   buf[0]  -->  number of records which are trained successfully.
+             buf[2i+1]  -->  record number
+             buf[2i+2]  -->  record train status.
+                00 --> Trained 
+                FE --> Train Time Out
+                FF --> Value out of range"
+             (i = 0 ~ len-1 )
+	@retval '>0' --> length of valid data in buf. 
+            0 --> success, and no data received.
+            '<0' --> failed.
+                -1 --> data format error.
+                -2 --> train timeout.
+*/
+int VRCore :: train(uint8_t *records, uint8_t len, uint8_t *buf)
+{
+	int ret;
+	unsigned long start_millis;
+	if(len == 0){
+		return -1;
+	}
+	
+	send_pkt(FRAME_CMD_TRAIN, records, len);
+	start_millis = millis();
+	while(1){
+		ret = receive_pkt(vr_buf);
+		if(ret>0){
+			switch(vr_buf[2]){
+				case FRAME_CMD_PROMPT:
+					if(prompt_cb != 0){
+						prompt_cb(0, VR_ASYNC_PROGRESS, vr_buf, ret, prompt_cb_arg);
+						break;
+					}
+					DBGSTR("Record:\t");
+					DBGFMT(vr_buf[3], DEC);
+					DBGSTR("\t");
+					DBGBUF(vr_buf+4, ret-4);
+					break;
+				case FRAME_CMD_TRAIN:
+					if(buf != 0){
+						memcpy(buf, vr_buf+3, vr_buf[1]-2);
+						return vr_buf[1]-2;
+					}
+					DBGSTR("Train finish.\r\nSuccess: \t");
+					DBGFMT(vr_buf[3], DEC);
+					DBGSTR(" \r\n");
+					return 0;
+					break;
+				default:
+					break;
+			}
+			start_millis = millis();
+		}
+		if(millis()-start_millis > 8000){
+			return -2;
+		}
+	}
+	return 0;
+}
+
+/**
+	@brief train one record.
+	@param records --> record data buffer pointer.
+		   len --> number of records.
+           buf --> pointer of return value buffer, optional.
+		   buf[0]  -->  number of records which are trained successfully.
+             buf[2i+1]  -->  record number
+             buf[2i+2]  -->  record train status.
+                00 --> Trained 
+                FE --> Train Time Out
+                FF --> Value out of range"
+             (i = 0 ~ len-1 )
+	@retval '>0' --> length of valid data in buf. 
+            0 --> success, and no data received.
+            '<0' --> failed.
+                -1 --> data format error.
+                -2 --> train timeout.
+*/
+int VRCore :: train(uint8_t record, uint8_t *buf)
+{
+    return train(&record, 1, buf);
+}
+
+/**
+	@brief train record and set a signature(alias) for this record.
+	@param record --> record value.
+           buf --> signature string/data pointer.
+		   len --> lenght of buf.
+		   retbuf --> return data .
+			 retbuf[0]  -->  number of records which are trained successfully.
+             retbuf[1]  -->  record number.
+             retbuf[2]  -->  record train status.
+                00 --> Trained 
+                F0 --> Trained, signature truncate
+                FE --> Train Time Out
+                FF --> Value out of range"
+             retbuf[3] ~ retbuf[retval-1] --> Signature.(retval means return value)
+	@retval '>0' --> length of valid data in buf. 
+            0 --> success, and no data received.
+            '<0' --> failed.
+                -1 --> data format error.
+                -2 --> train with signature timeout.
+*/
+int VRCore :: trainWithSignature(uint8_t record, const void *buf, uint8_t len, uint8_t * retbuf)
+{
+	int ret;
+	unsigned long start_millis;
+	if(len){
+		send_pkt(FRAME_CMD_SIG_TRAIN, record, (uint8_t *)buf, len);
+	}else{
+		if(buf == 0){
+			return -1;
+		}
+		len = strlen((char *)buf);
+		if(len>10){
+			return -1;
+		}
+		send_pkt(FRAME_CMD_SIG_TRAIN, record, (uint8_t *)buf, len);
+	}
+	
+	start_millis = millis();
+	while(1){
+		ret = receive_pkt(vr_buf);
+		if(ret>0){
+			switch(vr_buf[2]){
+				case FRAME_CMD_PROMPT:
+					if(prompt_cb != 0){
+						prompt_cb(0, VR_ASYNC_PROGRESS, vr_buf, ret, prompt_cb_arg);
+						break;
+					}
+					DBGSTR("Record:\t");
+					DBGFMT(vr_buf[3], DEC);
+					DBGSTR("\t");
+					DBGBUF(vr_buf+4, ret-4);
+					break;
+				case FRAME_CMD_SIG_TRAIN:
+					if(retbuf != 0){
+						memcpy(retbuf, vr_buf+3, vr_buf[1]-2);
+						return vr_buf[1]-2;
+					}
+				
+					DBGSTR("Train finish.\r\nSuccess: \t");
+					DBGFMT(vr_buf[3], DEC);
+					DBGSTR(" \r\n");
+					return 0;
+					break;
+				default:
+					break;
+			}
+			start_millis = millis();
+		}
+		if(millis()-start_millis > 8000){
+			return -2;
+		}
+	}
+	return 0;
+}
+
+/**
+    @brief set callback for prompt frames of train() and trainWithSignature(), 
+           handle is 0, buf[3] is the record, buf+4 is the prompt string. 
+           Without callback prompts are printed only when DEBUG is defined.
+*/
+void VRCore :: setPromptCallback(cmd_callback_t cb, void *arg)
+{
+	prompt_cb = cb;
+	prompt_cb_arg = arg;
+}
+#endif
+
+/**
+    @brief Load records to recognizer.
+    @param records --> record data buffer pointer.
+           len --> number of records.
+           buf --> pointer of return value buffer, optional.
+             buf[0]    -->  number of records which are load successfully.
+             buf[2i+1]  -->  record number
+             buf[2i+2]  -->  record load status.
+                00 --> Loaded 
+                FC --> Record already in recognizer
+                FD --> Recognizer full
+                FE --> Record untrained
+                FF --> Value out of range"
+             (i = 0 ~ '(retval-1)/2' )
+	@retval '>0' --> length of valid data in buf. 
+            0 --> success, buf=0, and no data returned.
+            '<0' --> failed.
+*/
+int VRCore :: load(uint8_t *records, uint8_t len, uint8_t *buf)
+{
+	uint8_t ret;
+#if VR_ENABLE_SHADOW
+	uint8_t i;
+	if(len != 0 && bsrLoaded(records, len)){
+		/** all records are in recognizer already, answer as module does */
+		if(buf != 0){
+			buf[0] = 0;
+			for(i=0; i<len; i++){
+				buf[2*i+1] = records[i];
+				buf[2*i+2] = 0xFC;
+			}
+			return 2*len+1;
+		}
+		return 0;
+	}
+#endif
+	send_pkt(FRAME_CMD_LOAD, records, len);
+	ret = receive_pkt(vr_buf);
+	if(ret<=0){
+		return -1;
+	}
+	if(vr_buf[2] != FRAME_CMD_LOAD){
+		return -1;
+	}
+	if(buf != 0){
+		memcpy(buf, vr_buf+3, vr_buf[1]-2);
+		return vr_buf[1]-2;
+	}
+	return 0;
+}
+
+/**
+    @brief Load one record to recognizer.
+    @param record --> record value.
+           buf --> pointer of return value buffer, optional.
+             buf[0]    -->  number of records which are load successfully.
+             buf[2i+1]  -->  record number
+             buf[2i+2]  -->  record load status.
+                00 --> Loaded 
+                FC --> Record already in recognizer
+                FD --> Recognizer full
+                FE --> Record untrained
+                FF --> Value out of range"
+             (i = 0 ~ '(retval-1)/2' )
+	@retval '>0' --> length of valid data in buf. 
+            0 --> success, buf=0, and no data returned.
+            '<0' --> failed.
+*/
+int VRCore :: load(uint8_t record, uint8_t *buf)
+{
+	return load(&record, 1, buf);
+}
+
+/**
+    @brief Load a set of records to recognizer, in ascending order.
+    @param records --> 1~7 records.
+           buf --> same as load(records, len, buf).
+    @retval same as load(records, len, buf), -1 if the set is empty or holds 
+            more than 7 records.
+*/
+int VRCore :: load(const RecordSet &records, uint8_t *buf)
+{
+	uint8_t list[7];
+	if(records.empty() || records.count() > 7){
+		return -1;
+	}
+	return load(list, records.toArray(list, 7), buf);
+}
+
+/**
+    @brief set signature(alias) for a record.
+    @param record --> record value.
+           buf --> signature buffer.
+           len --> length of buf.
+    @retval 0 --> success, buf=0, and no data returned.
+            '<0' --> failed.
+*/
+int VRCore :: setSignature(uint8_t record, const void *buf, uint8_t len)
+{
+	int ret;
+	
+	if(len == 0 && buf == 0){
+		/** delete signature */
+	}else if(len == 0 && buf != 0){
+		if(buf == 0){
+			return -1;
+		}
+		len = strlen((char *)buf);
+		if(len>10){
+			return -1;
+		}
+	}else if(len != 0 && buf != 0){
+		
+	}else{
+		return -1;
+	}
+	send_pkt(FRAME_CMD_SET_SIG, record, (uint8_t *)buf, len);
+	ret = receive_pkt(vr_buf);
+	if(ret<=0){
+		return -1;
+	}
+	if(vr_buf[2] != FRAME_CMD_SET_SIG){
+		return -1;
+	}
+	return 0;
+}
+
+/**
+    @brief delete signature(alias) of a record.
+    @param record --> record value.
+    @retval  0 --> success
+            -1 --> failed
+*/
+int VRCore :: deleteSignature(uint8_t record)
+{
+    return setSignature(record);
+}
+
+/**
+    @brief check the signature(alias) of a record.
+    @param record --> record value.
+           buf --> signature, return value buffer.
+    @retval '>0' --> length of valid data in buf. 
+            0 --> success, buf=0, and no data returned.
+            '<0' --> failed.
+*/
+int VRCore :: checkSignature(uint8_t record, uint8_t *buf)
+{
+	int ret;
+	if(record < 0){
+		return -1;
+	}
+	send_pkt(FRAME_CMD_CHECK_SIG, record, 0, 0);
+	ret = receive_pkt(vr_buf);
+	
+	if(ret<=0){
+		return -1;
+	}
+	if(vr_buf[2] != FRAME_CMD_CHECK_SIG){
+		return -1;
+	}
+
+	if(vr_buf[4]>0){
+		memcpy(buf, vr_buf+5, vr_buf[4]);
+		return vr_buf[4];
+	}else{
+		return 0;
+	}
+}
+
+/**
+    @brief clear recognizer.
+    @retval  0 --> success
+            -1 --> failed
+*/
+int VRCore :: clear()
+{	
+	int len;
+#if VR_ENABLE_SHADOW
+	if(bsrLoaded(0, 0)){
+		/** recognizer is empty already */
+		return 0;
+	}
+#endif
+	send_pkt(FRAME_CMD_CLEAR, 0, 0);
+	len = receive_pkt(vr_buf);
+	if(len<=0){
+		return -1;
+	}
+
+	if(vr_buf[2] != FRAME_CMD_CLEAR){
+		return -1;
+	}
+	//DBGLN("VR Module Cleared");
+	return 0;
+}
+
+/**
+    @brief clear recognizer.
+    @param buf --> return value buffer.
+             buf[0]     -->  Number of valid voice records in recognizer
+             buf[i+1]   -->  Record number.(0xFF: Not loaded(Nongroup mode), or not set (Group mode)) 
+                (i= 0, 1, ... 6)
+             buf[8]     -->  Number of all voice records in recognizer
+             buf[9]     -->  Valid records position indicate.
+             buf[10]    -->  Group mode indicate(FF: None Group, 0x8n: User, 0x0n:System
+    @retval '>0' --> success, length of data in buf 
+            -1 --> failed
+*/
+int VRCore :: checkRecognizer(uint8_t *buf)
+{
+	int len;
+	send_pkt(FRAME_CMD_CHECK_BSR, 0, 0);
+	len = receive_pkt(vr_buf);
+	if(len<=0){
+		return -1;
+	}
+
+	if(vr_buf[2] != FRAME_CMD_CHECK_BSR){
+		return -1;
+	}
+	
+	if(vr_buf[1] != 0x0D){
+		return -1;
+	}
+	
+	memcpy(buf, vr_buf+3, vr_buf[1]-2);
+	
+	return vr_buf[1]-2;
+}
+
+/**
+    @brief check record train status.
+    @param buf --> return value, 255 bytes when all records are checked, 
+                   buf[r] is the status of record r, F0 if not reported. 
+                   0 with records=0 only refreshes the trained record cache.
+             buf[0]     -->  Number of checked records
+             buf[2i+1]  -->  Record number.
+             buf[2i+2]  -->  Record train status. (00: untrained, 01: trained, FF: record value out of range)
+             (i = 0 ~ buf[0]-1 )
+    @retval Number of trained records
+*/
+int VRCore :: checkRecord(uint8_t *buf, uint8_t *records, uint8_t len)
+{
+	int ret, i;
+	int cnt = 0;
+	uint16_t timeout;
+	unsigned long start_millis;
+	if(records == 0 && len==0){
+#if VR_ENABLE_RECORD_CACHE
+		if(recKnown(0, 0)){
+			/** answer from trained record cache, records 80~ not reported */
+			if(buf != 0){
+				memset(buf, 0xF0, 255);
+			}
+			for(i=0; i<80; i++){
+				ret = (rec_trained[i>>3]>>(i&7))&1;
+				if(buf != 0){
+					buf[i] = ret;
+				}
+				cnt += ret;
+			}
+			return cnt;
+		}
+#endif
+		if(buf != 0){
+			memset(buf, 0xF0, 255);
+		}
+		send_pkt(FRAME_CMD_CHECK_TRAIN, 0xFF, 0, 0);
+		timeout = rtoGet(tx_cmd, tx_len);
+		start_millis = millis();
+		while(1){
+			ret = receive_pkt(vr_buf);
+			if(ret>0){
+				if(vr_buf[2] == FRAME_CMD_CHECK_TRAIN){
+                    for(i=0; buf!=0 && i<vr_buf[1]-3; i+=2){
+                        buf[vr_buf[4+i]]=vr_buf[4+i+1];
+                    }
+					cnt++;
+					if(cnt == 51){
+						return vr_buf[3];
+					}
+				}else{
+					return -3;
+				}
+				start_millis = millis();
+				timeout = gapTimeout(tx_cmd, tx_len);
+			}
+			
+			if(millis()-start_millis > timeout){
+				if(cnt>0){
+					if(buf != 0){
+						buf[0] = cnt*5;
+					}
+					return vr_buf[3];
+				}
+				return -2;
+			}
+			
+		}
+		
+	}else if(len>0){
+		ret = cleanDup(vr_buf, records, len);
+#if VR_ENABLE_RECORD_CACHE
+		if(recKnown(vr_buf, ret)){
+			/** answer from trained record cache */
+			buf[0] = ret;
+			for(i=0; i<ret; i++){
+				buf[2*i+1] = vr_buf[i];
+				if(vr_buf[i] < 80){
+					buf[2*i+2] = (rec_trained[vr_buf[i]>>3]>>(vr_buf[i]&7))&1;
+					cnt += buf[2*i+2];
+				}else{
+					buf[2*i+2] = 0xFF;
+				}
+			}
+			return cnt;
+		}
+#endif
+		send_pkt(FRAME_CMD_CHECK_TRAIN, vr_buf, ret);
+		ret = receive_pkt(vr_buf);
+		if(ret>0){
+			if(vr_buf[2] == FRAME_CMD_CHECK_TRAIN){
+				memcpy(buf+1, vr_buf+4, vr_buf[1]-3);
+				buf[0] = (vr_buf[1]-3)/2;
+				return vr_buf[3];
+			}else{
+				return -3;
+			}
+		}else{
+			return -1;
+		}
+	}else{
+		return -1;
+	}
+	
+}
+
+/**
+    @brief check train status of a set of records, in ascending order, 7 
+           records per frame. Seven records the trained record cache knows 
+           are answered without a frame.
+    @param buf --> return value, 1+2*records.count() bytes(161 at most), 
+                   same layout as checkRecord(buf, records, len).
+           records --> 1~80 records.
+    @retval '>=0' --> number of trained records
+            '<0' --> failed, -1 if the set is empty
+*/
+int VRCore :: checkRecord(uint8_t *buf, const RecordSet &records)
+{
+	uint8_t list[7], part[15], n;
+	int r = -1, ret, cnt = 0;
+	if(records.empty()){
+		return -1;
+	}
+	buf[0] = 0;
+	do{
+		for(n=0; n<7 && (r = records.next(r)) >= 0; n++){
+			list[n] = r;
+		}
+		if(n == 0){
+			break;
+		}
+		ret = checkRecord(part, list, n);
+		if(ret < 0){
+			return ret;
+		}
+		memcpy(buf+1+2*buf[0], part+1, 2*part[0]);
+		buf[0] += part[0];
+		cnt += ret;
+	}while(n == 7);
+	return cnt;
+}
+
+#if VR_ENABLE_RECORD_CACHE
+/**
+    @brief check if a record is trained, from trained record cache. Only an 
+           unknown record is checked by module.
+    @param record --> record value.
+    @retval  1 --> trained
+             0 --> untrained
+            -1 --> failed
+*/
+int VRCore :: isTrained(uint8_t record)
+{
+	uint8_t buf[3];
+	if(record >= 80){
+		return 0;
+	}
+	if(!recKnown(&record, 1)){
+		if(checkRecord(buf, &record, 1) < 0 || !recKnown(&record, 1)){
+			return -1;
+		}
+	}
+	return (rec_trained[record>>3]>>(record&7))&1;
+}
+
+/**
+    @brief get trained status of all records, from trained record cache. 
+           Module is scanned once when any record is unknown.
+    @param map --> 10 bytes bit map, bit (r%8) of map[r/8] is set if record r 
+                   is trained.
+    @retval '>=0' --> number of trained records
+            '<0' --> failed
+*/
+int VRCore :: getTrainedMap(uint8_t *map)
+{
+	int i, cnt = 0;
+	if(!recKnown(0, 0) && refreshRecordCache() < 0){
+		return -1;
+	}
+	for(i=0; i<80; i++){
+		cnt += (rec_trained[i>>3]>>(i&7))&1;
+	}
+	if(map != 0){
+		memcpy(map, rec_trained, sizeof(rec_trained));
+	}
+	return cnt;
+}
+
+/**
+    @brief reload trained record cache, one full checkRecord() scan.
+    @retval '>=0' --> number of trained records
+            '<0' --> failed
+*/
+int VRCore :: refreshRecordCache()
+{
+	invalidateRecordCache();
+	return checkRecord(0);
+}
+#endif
+
+/**
+    @brief forget trained record cache, e.g. records are trained by other host.
+*/
+void VRCore :: invalidateRecordCache()
+{
+#if VR_ENABLE_RECORD_CACHE
+	memset(rec_known, 0, sizeof(rec_known));
+#endif
+}
+
+#if VR_ENABLE_RECORD_CACHE
+/** update trained record cache from the frame in vr_buf */
+void VRCore :: recTrack()
+{
+	uint8_t i;
+	switch(vr_buf[2]){
+		case FRAME_CMD_CHECK_TRAIN:
+			/** record, status(01 trained) */
+			for(i=4; i<vr_buf[1]; i+=2){
+				recSet(vr_buf[i], vr_buf[i+1] == 0x01 ? 0x00 : 0xFE);
+			}
+			break;
+		case FRAME_CMD_LOAD:
+			/** record, status(00 loaded, FC already loaded, FE untrained) */
+			for(i=4; i<vr_buf[1]; i+=2){
+				recSet(vr_buf[i], vr_buf[i+1]);
+			}
+			break;
+		case FRAME_CMD_TRAIN:
+			/** 
+			  record, status(00 trained, FE train timeout). A failed training 
+			  may leave the old one, the record is unknown.
+			*/
+			for(i=4; i<vr_buf[1]; i+=2){
+				recSet(vr_buf[i], vr_buf[i+1] == 0x00 ? 0x00 : 0xFF);
+			}
+			break;
+		case FRAME_CMD_SIG_TRAIN:
+			/** F0 trained, signature truncated */
+			recSet(vr_buf[4], vr_buf[5] == 0x00 || vr_buf[5] == 0xF0 ? 0x00 : 0xFF);
+			break;
+		default:
+			break;
+	}
+}
+
+/** set trained status of record, sta: 00 trained, FE untrained, other unknown */
+void VRCore :: recSet(uint8_t record, uint8_t sta)
+{
+	uint8_t bit;
+	if(record >= 80){
+		return;
+	}
+	bit = 1<<(record&7);
+	if(sta == 0x00 || sta == 0xFC){
+		rec_trained[record>>3] |= bit;
+		rec_known[record>>3] |= bit;
+	}else if(sta == 0xFE){
+		rec_trained[record>>3] &= ~bit;
+		rec_known[record>>3] |= bit;
+	}else{
+		rec_known[record>>3] &= ~bit;
+	}
+}
+
+/** check if trained status of records is cached, len 0 checks all records */
+bool VRCore :: recKnown(uint8_t *records, uint8_t len)
+{
+	uint8_t i;
+	if(len == 0){
+		for(i=0; i<10; i++){
+			if(rec_known[i] != 0xFF){
+				return false;
+			}
+		}
+		return true;
+	}
+	for(i=0; i<len; i++){
+		if(records[i] < 80 && !(rec_known[records[i]>>3] & (1<<(records[i]&7)))){
+			return false;
+		}
+	}
+	return true;
+}
+#endif
+
+#if VR_ENABLE_SIG_CACHE
+/****************************************************************************/
+/***************************** SIGNATURE CACHE ******************************/
+#define VR_SIG_CACHE_MAGIC						(0x56)
+
+/**
+    @brief use the signature cache kept by the last fillSignatureCache(), 
+           e.g. after a reset. No checkSignature() traffic.
+    @param verify --> check that the cache was filled from this module, by 
+                      the stamp of its trained records(one check record scan 
+                      unless trained record cache is known).
+    @retval '>=0' --> success, number of cached records.
+            -1 --> no cache, or it belongs to another module state. Call 
+                   fillSignatureCache().
+*/
+int VRCore :: loadSignatureCache(bool verify)
+{
+	uint8_t head[VR_SIG_CACHE_HEAD], len;
+	uint16_t stamp;
+	int i, cnt = 0;
+	
+	sig_on = 0;
+	sigRead(0, head, VR_SIG_CACHE_HEAD);
+	if(head[0] != VR_SIG_CACHE_MAGIC || head[1] != VR_SIG_CACHE_LEN){
+		return -1;
+	}
+	if(verify && (sigStamp(&stamp) < 0 || stamp != (head[2] | (head[3]<<8)))){
+		return -1;
+	}
+	sig_on = 1;
+	for(i=0; i<80; i++){
+		sigRead(VR_SIG_CACHE_HEAD + i*VR_SIG_CACHE_SLOT, &len, 1);
+		if(len != 0xFF){
+			cnt++;
+		}
+	}
+	return cnt;
+}
+
+/**
+    @brief read the signatures of all records into the signature cache, in 
+           one pipelined batch when asynchronous commands are enabled. Later 
+           set/train/check signature responses keep it up to date.
+    @retval '>=0' --> success, number of records with a signature.
+            -1 --> failed, records which did not answer stay unknown and are 
+                   asked by getSignature().
+*/
+int VRCore :: fillSignatureCache()
+{
+	uint8_t head[VR_SIG_CACHE_HEAD], len;
+	uint16_t stamp;
+	int i, fail = 0, cnt = 0;
+	
+	if(sigStamp(&stamp) < 0){
+		return -1;
+	}
+	head[0] = VR_SIG_CACHE_MAGIC;
+	head[1] = VR_SIG_CACHE_LEN;
+	head[2] = stamp;
+	head[3] = stamp>>8;
+	sigWrite(0, head, VR_SIG_CACHE_HEAD);
+	len = 0xFF;
+	for(i=0; i<80; i++){
+		sigWrite(VR_SIG_CACHE_HEAD + i*VR_SIG_CACHE_SLOT, &len, 1);
+	}
+	sig_on = 1;
+	
+#if VR_ENABLE_ASYNC
+	/** responses are stored by sigTrack() */
+	beginBatch();
+	for(i=0; i<80; i++){
+		checkSignatureAsync(i, 0);
+	}
+	fail = endBatch();
+#else
+	uint8_t buf[VR_BUF_SIZE];
+	for(i=0; i<80; i++){
+		if(checkSignature(i, buf) < 0){
+			fail++;
+		}
+	}
+#endif
+	if(fail){
+		return -1;
+	}
+	for(i=0; i<80; i++){
+		sigRead(VR_SIG_CACHE_HEAD + i*VR_SIG_CACHE_SLOT, &len, 1);
+		if(len != 0xFF && len != 0){
+			cnt++;
+		}
+	}
+	return cnt;
+}
+
+/**
+    @brief get signature of a record, from signature cache. Only an unknown 
+           record is checked by module.
+    @param record --> record value.
+           buf --> signature buffer, VR_SIG_MAX bytes.
+    @retval '>=0' --> signature length, 0 if record has none.
+            -1 --> failed
+*/
+int VRCore :: getSignature(uint8_t record, uint8_t *buf)
+{
+	int ret;
+	if(record >= 80){
+		return -1;
+	}
+	ret = sigFetch(record, buf);
+	if(ret < 0){
+		ret = checkSignature(record, buf);
+	}
+	return ret;
+}
+
+/**
+    @brief forget signature cache, e.g. module is replaced or signatures are 
+           set by other host. Call fillSignatureCache() to rebuild it.
+*/
+void VRCore :: invalidateSignatureCache()
+{
+	uint8_t magic = 0xFF;
+	sigWrite(0, &magic, 1);
+	sig_on = 0;
+}
+
+/** update signature cache from the frame in vr_buf */
+void VRCore :: sigTrack()
+{
+	uint8_t len;
+	if(!sig_on || vr_buf[1] < 4){
+		return;
+	}
+	switch(vr_buf[2]){
+		case FRAME_CMD_CHECK_SIG:
+			/** record, length, signature */
+			len = vr_buf[4] < vr_buf[1]-4 ? vr_buf[4] : vr_buf[1]-4;
+			sigStore(vr_buf[3], vr_buf+5, len);
+			break;
+		case FRAME_CMD_SET_SIG:
+			/** 00, record, signature */
+			sigStore(vr_buf[4], vr_buf+5, vr_buf[1]-4);
+			break;
+		case FRAME_CMD_TRAIN:
+			/** trained map changed, recTrack() has run already */
+			sigRestamp();
+			break;
+		case FRAME_CMD_SIG_TRAIN:
+			/** number, record, status(00/F0 trained), signature */
+			if(vr_buf[1] >= 5 && (vr_buf[5] == 0x00 || vr_buf[5] == 0xF0)){
+				sigStore(vr_buf[4], vr_buf+6, vr_buf[1]-5);
+			}
+			sigRestamp();
+			break;
+		case FRAME_CMD_VR:
+			/** a signature sent with the result is taken, none keeps cache */
+			if(vr_buf[1] >= 7 && vr_buf[7] != 0){
+				len = vr_buf[7] < vr_buf[1]-7 ? vr_buf[7] : vr_buf[1]-7;
+				sigStore(vr_buf[5], vr_buf+8, len);
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+/** keep signature of a record, a longer one than VR_SIG_CACHE_LEN stays unknown */
+void VRCore :: sigStore(uint8_t record, const uint8_t *sig, uint8_t len)
+{
+	uint8_t slot[VR_SIG_CACHE_SLOT];
+	if(record >= 80){
+		return;
+	}
+	if(len > VR_SIG_CACHE_LEN){
+		slot[0] = 0xFF;
+		len = 0;
+	}else{
+		slot[0] = len;
+		memcpy(slot+1, sig, len);
+	}
+	sigWrite(VR_SIG_CACHE_HEAD + record*VR_SIG_CACHE_SLOT, slot, len+1);
+}
+
+/** signature from cache, -1 if unknown */
+int VRCore :: sigFetch(uint8_t record, uint8_t *buf)
+{
+	uint8_t len;
+	uint16_t addr = VR_SIG_CACHE_HEAD + record*VR_SIG_CACHE_SLOT;
+	if(!sig_on || record >= 80){
+		return -1;
+	}
+	sigRead(addr, &len, 1);
+	if(len == 0xFF){
+		return -1;
+	}
+	sigRead(addr+1, buf, len);
+	return len;
+}
+
+/** stamp of module state, hash of its trained record map */
+int VRCore :: sigStamp(uint16_t *stamp)
+{
+	uint8_t map[10], i;
+	uint16_t h = 5381;
+	if(getTrainedMap(map) < 0){
+		return -1;
+	}
+	for(i=0; i<10; i++){
+		h = (h<<5) + h + map[i];
+	}
+	*stamp = h;
+	return 0;
+}
+
+/** 
+	training through the library changes the trained map, keep the stamp 
+	of the cache with it. Only from the trained record cache, no frame is 
+	sent from here; with a record unknown(e.g. failed training) the old 
+	stamp stays and the next verified load refuses the cache.
+*/
+void VRCore :: sigRestamp()
+{
+	uint16_t stamp;
+	uint8_t buf[2];
+	if(!recKnown(0, 0) || sigStamp(&stamp) < 0){
+		return;
+	}
+	buf[0] = stamp;
+	buf[1] = stamp>>8;
+	sigWrite(2, buf, 2);
+}
+
+void VRCore :: sigRead(uint16_t addr, void *buf, uint8_t len)
+{
+#if defined(ARDUINO) && defined(__AVR__)
+	eeprom_read_block(buf, (const void *)(VR_SIG_CACHE_BASE+addr), len);
+#else
+	memcpy(buf, sig_mem+addr, len);
+#endif
+}
+
+/** EEPROM is written only where bytes change */
+void VRCore :: sigWrite(uint16_t addr, const void *buf, uint8_t len)
+{
+#if defined(ARDUINO) && defined(__AVR__)
+	eeprom_update_block(buf, (void *)(VR_SIG_CACHE_BASE+addr), len);
+#else
+	memcpy(sig_mem+addr, buf, len);
+#endif
+}
+#endif
+
+#if VR_ENABLE_SHADOW
+/**
+    @brief refresh recognizer shadow from module, one check recognizer command.
+    @retval  0 --> success
+            -1 --> failed
+*/
+int VRCore :: resync()
+{
+	uint8_t buf[11];
+	bsr_valid = 0;
+	return checkRecognizer(buf) > 0 ? 0 : -1;
+}
+
+/**
+    @brief get recognizer content from shadow, no serial traffic.
+    @param buf --> return value buffer, same as checkRecognizer().
+    @retval '>0' --> success, length of data in buf 
+            -1 --> shadow is not valid, call resync().
+*/
+int VRCore :: getRecognizer(uint8_t *buf)
+{
+	if(!bsr_valid){
+		return -1;
+	}
+	bsrFill(buf);
+	return 11;
+}
+#endif
+
+/**
+    @brief mark recognizer shadow unknown, e.g. module is reset or controlled 
+           by other host. Next load/clear goes to module.
+*/
+void VRCore :: invalidateRecognizer()
+{
+#if VR_ENABLE_SHADOW
+	bsr_valid = 0;
+	saved_frames = 0;
+	saved_bytes = 0;
+#endif
+	invalidateRecordCache();
+}
+
+#if VR_ENABLE_SHADOW
+/**
+    @brief make records the content of recognizer with fewest frames. Only 
+           missing records are loaded when no record has to be removed, 
+           recognizer is cleared only when records must be evicted. Traffic 
+           saved compared with clear() + load() is added to getSavedFrames() 
+           and getSavedBytes().
+    @param records --> target records, duplicates are ignored.
+           len --> length of records(0~7), 0 empties recognizer.
+    @retval  0 --> success
+            -1 --> failed
+*/
+int VRCore :: setActiveRecords(uint8_t *records, uint8_t len)
+{
+	uint8_t i;
+	if(len > 7 || (len != 0 && records == 0)){
+		return -1;
+	}
+	for(i=0; i<len; i++){
+		if(records[i] >= RecordSet::VR_RECORD_NUM){
+			return -1;
+		}
+	}
+	return setActiveRecords(RecordSet(records, len));
+}
+
+/**
+    @brief same as setActiveRecords(records, len), missing records are 
+           loaded in ascending order.
+    @param records --> target records, 0~7, an empty set empties recognizer.
+    @retval  0 --> success
+            -1 --> failed
+*/
+int VRCore :: setActiveRecords(const RecordSet &records)
+{
+	RecordSet active, missing;
+	uint8_t list[7];
+	uint8_t n, m, j;
+	int frames = 0, bytes = 0;
+	
+	n = records.count();
+	if(n > 7){
+		return -1;
+	}
+	
+	if(!bsr_valid || bsr_grpm != 0xFF){
+		frames++;
+		bytes += 4 + 15;
+		if(resync() != 0){
+			return -1;
+		}
+	}
+	
+	for(j=0; j<7; j++){
+		if(bsr[j] != 0xFF){
+			active.add(bsr[j]);
+		}
+	}
+	missing = records;
+	if(bsr_grpm != 0xFF || !(active - records).empty()){
+		/** records must be evicted */
+		frames++;
+		bytes += 4 + 5;
+		if(clear() != 0){
+			return -1;
+		}
+	}else{
+		missing -= active;
+	}
+	
+	m = missing.toArray(list, 7);
+	if(m != 0){
+		frames++;
+		bytes += (4 + m) + (5 + 2*m);
+		if(load(list, m) != 0){
+			return -1;
+		}
+	}
+	
+	/** clear() + load() */
+	saved_frames += (n ? 2 : 1) - frames;
+	saved_bytes += (n ? 18 + 3*n : 9) - bytes;
+	return 0;
+}
+
+/** update recognizer shadow from the frame in vr_buf */
+void VRCore :: bsrTrack()
+{
+	uint8_t i, j;
+	switch(vr_buf[2]){
+		case FRAME_CMD_CLEAR:
+			memset(bsr, 0xFF, 7);
+			bsr_grpm = 0xFF;
+			bsr_valid = 1;
+			break;
+		case FRAME_CMD_CHECK_BSR:
+		case FRAME_CMD_GROUP:
+			/** check recognizer, load system/user group */
+			if(vr_buf[1] == 0x0D){
+				memcpy(bsr, vr_buf+4, 7);
+				bsr_grpm = vr_buf[13];
+				bsr_valid = 1;
+			}
+			break;
+		case FRAME_CMD_LOAD:
+			if(bsr_grpm != 0xFF){
+				bsr_valid = 0;
+			}
+			if(!bsr_valid){
+				break;
+			}
+			/** loaded records take the first free positions */
+			for(i=4; i<vr_buf[1]; i+=2){
+				if(vr_buf[i+1] != 0x00){
+					continue;
+				}
+				for(j=0; j<7; j++){
+					if(bsr[j] == 0xFF){
+						bsr[j] = vr_buf[i];
+						break;
+					}
+				}
+				if(j == 7){
+					bsr_valid = 0;
+				}
+			}
+			break;
+		case FRAME_CMD_VR:
+			if(bsr_valid && (vr_buf[4] != bsr_grpm || vr_buf[6] >= 7 || bsr[vr_buf[6]] != vr_buf[5])){
+				bsr_valid = 0;
+			}
+			break;
+		case FRAME_CMD_TRAIN:
+		case FRAME_CMD_SIG_TRAIN:
+		case FRAME_CMD_TEST:
+		case FRAME_CMD_RESET_DEFAULT:
+			bsr_valid = 0;
+			break;
+		default:
+			break;
+	}
+}
+
+/** recognizer shadow in checkRecognizer() format */
+void VRCore :: bsrFill(uint8_t *buf)
+{
+	uint8_t i, cnt = 0, map = 0;
+	for(i=0; i<7; i++){
+		buf[i+1] = bsr[i];
+		if(bsr[i] != 0xFF){
+			cnt++;
+			map |= 1<<i;
+		}
+	}
+	buf[0] = cnt;
+	buf[8] = cnt;
+	buf[9] = map;
+	buf[10] = bsr_grpm;
+}
+
+/** check if all records are in recognizer shadow, len 0 checks empty */
+bool VRCore :: bsrLoaded(uint8_t *records, uint8_t len)
+{
+	uint8_t i, j;
+	if(!bsr_valid || bsr_grpm != 0xFF){
+		return false;
+	}
+	if(len == 0){
+		for(j=0; j<7; j++){
+			if(bsr[j] != 0xFF){
+				return false;
+			}
+		}
+		return true;
+	}
+	for(i=0; i<len; i++){
+		for(j=0; j<7; j++){
+			if(bsr[j] == records[i]){
+				break;
+			}
+		}
+		if(j == 7){
+			return false;
+		}
+	}
+	return true;
+}
+#endif
+
+#if VR_ENABLE_GROUP
+/****************************************************************************/
+/******************************* GROUP CONTROL ******************************/
+/**
+    @brief set group control by external IO function
+    @param ctrl --> group control by external IO
+                0 --> disable group control by external IO
+                1 --> user group control by external IO
+                2 --> system group control by external IO
+    @retval  0 --> success
+            -1 --> failed
+*/
+int VRCore :: setGroupControl(uint8_t ctrl)
+{
+	int ret;
+	if(ctrl>2){
+		return -1;
+	}
+	
+	send_pkt(FRAME_CMD_GROUP, FRAME_CMD_GROUP_SET, &ctrl, 1);
+#if VR_ENABLE_SHADOW
+	/** external IO may switch groups */
+	bsr_valid = 0;
+#endif
+	ret = receive_pkt(vr_buf);
+	if(ret<=0){
+		return -1;
+	}
+
+	if(vr_buf[2] != FRAME_CMD_GROUP){
+		return -1;
+	}
+	return 0;
+}
+
+/**
+    @brief check group control by external IO function
+    @param ctrl --> group control by external IO
+    @retval  0 --> group control by external IO disabled
+             1 --> user group control by external IO status
+             2 --> system group control by external IO status
+            -1 --> failed
+*/
+int VRCore :: checkGroupControl()
+{
+	uint8_t cmd;
+	int ret;
+	cmd = 0xFF;
+	send_pkt(FRAME_CMD_GROUP, FRAME_CMD_GROUP_SET, &cmd, 1);
+	ret = receive_pkt(vr_buf);
+	if(ret<=0){
+		return -1;
+	}
+
+	if(vr_buf[2] != FRAME_CMD_GROUP){
+		return -1;
+	}
+	ret = vr_buf[5];
+	if(ret == 0xFF){
+		ret = 0;
+	}
+	return ret;
+}
+
+/**
+    @brief set user gruop content.
+    @param grp --> user group number.
+           records --> pointer of records buffer.
+           len --> length of reocrds
+    @retval  0 --> success
+            -1 --> failed
+*/
+int VRCore :: setUserGroup(uint8_t grp, uint8_t *records, uint8_t len)
+{
+	int ret;
+	if(len == 0 || records == 0){
+		return -1;
+	}
+	if(grp >= 8){
+		return -1;
+	}
+	vr_buf[0] = grp;
+	memcpy(vr_buf+1, records, len);
+	send_pkt(FRAME_CMD_GROUP, FRAME_CMD_GROUP_SUGRP, vr_buf, len+1);
+#if VR_ENABLE_SHADOW
+	if(bsr_grpm == (0x80|grp)){
+		bsr_valid = 0;
+	}
+#endif
+	ret = receive_pkt(vr_buf);
+	if(ret<=0){
+		return -1;
+	}
+	if(vr_buf[2] != FRAME_CMD_GROUP){
+		return -1;
+	}
+	return 0;
+}
+
+/**
+    @brief set a user group from a set of records, in ascending order.
+    @param grp --> user group number.
+           records --> 1~7 records.
+    @retval 0 --> success
+            -1 --> failed
+*/
+int VRCore :: setUserGroup(uint8_t grp, const RecordSet &records)
+{
+	uint8_t list[7];
+	if(records.count() > 7){
+		return -1;
+	}
+	return setUserGroup(grp, list, records.toArray(list, 7));
+}
+
+/**
+    @brief check user gruop content.
+    @param grp --> user group number.
+           buf --> return value
+             buf[8i]    -->  group number.
+             buf[8i+1]  -->  group position 0 status.
+             buf[8i+2]  -->  group position 1 status.
+               ...                ...
+             buf[8i+6]  -->  group position 5 status.
+             buf[8i+7]  -->  group position 6 status.
+             (i = 0 ~ @retval)
+    @retval '>0' --> number of checked user group
+            '<0' --> failed
+*/
+int VRCore :: checkUserGroup(uint8_t grp, uint8_t *buf)
+{
+	int ret;
+	int cnt = 0;
+	uint16_t timeout;
+	unsigned long start_millis;
+	
+	if(grp == GROUP_ALL){
+		send_pkt(FRAME_CMD_GROUP, FRAME_CMD_GROUP_CUGRP, 0, 0);
+		timeout = rtoGet(tx_cmd, tx_len);
+		start_millis = millis();
+		while(1){
+			ret = receive_pkt(vr_buf);
+			if(ret>0){
+				if(vr_buf[2] == FRAME_CMD_GROUP && vr_buf[1] == 10){
+					memcpy(buf+8*cnt, vr_buf+3, vr_buf[1]-2);
+					cnt++;
+					if(cnt == 8){
+						return cnt;
+					}
+				}else{
+					return -3;
+				}
+				start_millis = millis();
+				timeout = gapTimeout(tx_cmd, tx_len);
+			}
+			
+			if(millis()-start_millis > timeout){
+				if(cnt>0){
+					return cnt;
+				}
+				return -2;
+			}
+			
+		}
+	}else if(grp <= GROUP7){
+		send_pkt(FRAME_CMD_GROUP, FRAME_CMD_GROUP_CUGRP, &grp, 1);
+		ret = receive_pkt(vr_buf);
+		if(ret>0){
+			if(vr_buf[2] == FRAME_CMD_GROUP && vr_buf[1] == 10){
+				memcpy(buf+8*cnt, vr_buf+3, vr_buf[1]-2);
+				return 1;
+			}else{
+				return -3;
+			}
+		}else{
+			return -2;
+		}
+	}else{
+		return -1;
+	}
+}
+
+/**
+    @brief load system gruop content to recognizer.
+    @param grp --> syestem group number.
+           buf  -->  return value.
+             buf[0]     -->  Number of valid voice records in recognizer.
+             buf[i+1]   -->  Record number.(0xFF: Not loaded(Nongroup mode), or not set (Group mode)) 
+                (i= 0, 1, ... 6)
+             buf[8]     -->  Number of all voice records in recognizer
+             buf[9]     -->  Valid records position indicate.
+             buf[10]    -->  Group mode indicate(FF: None Group, 0x8n: User, 0x0n:System
+             (i = 0 ~ @retval)
+    @retval '>0' --> length of buf
+            '<0' --> failed
+*/
+int VRCore :: loadSystemGroup(uint8_t grp, uint8_t *buf)
+{
+	int ret;
+	if(grp > 10){
+		return -1;
+	}
+#if VR_ENABLE_SHADOW
+	if(bsr_valid && bsr_grpm == grp){
+		/** group is loaded already */
+		if(buf != 0){
+			bsrFill(buf);
+			return 11;
+		}
+		return 0;
+	}
+#endif
+	send_pkt(FRAME_CMD_GROUP, FRAME_CMD_GROUP_LSGRP, &grp, 1);
+	ret = receive_pkt(vr_buf);
+	
+	if(ret <= 0){
+		return -1;
+	}
+	
+	if(vr_buf[2] != FRAME_CMD_GROUP){
+		return -1;
+	}
+	
+	if(buf != 0){
+		vr_buf[3] = 0;
+		for(int i=0; i<8; i++){
+			if(vr_buf[12]&(1<<i)){
+				vr_buf[3]++;
+			}
+		}
+		memcpy(buf, vr_buf+3, vr_buf[1]-2);
+		return vr_buf[1]-2;
+	}
+	
+	return 0;
+}
+
+/**
+    @brief load user gruop content to recognizer.
+    @param grp --> user group number.
+           buf  -->  return value.
+             buf[0]     -->  Number of valid voice records in recognizer.
+             buf[i+1]   -->  Record number.(0xFF: Not loaded(Nongroup mode), or not set (Group mode)) 
+                (i= 0, 1, ... 6)
+             buf[8]     -->  Number of all voice records in recognizer
+             buf[9]     -->  Valid records position indicate.
+             buf[10]    -->  Group mode indicate(FF: None Group, 0x8n: User, 0x0n:System)
+             (i = 0 ~ @retval)
+    @retval '>0' --> length of buf
+            '<0' --> failed
+*/
+int VRCore :: loadUserGroup(uint8_t grp, uint8_t *buf)
+{
+	int ret;
+	if(grp > GROUP7){
+		return -1;
+	}
+#if VR_ENABLE_SHADOW
+	if(bsr_valid && bsr_grpm == (0x80|grp)){
+		/** group is loaded already */
+		if(buf != 0){
+			bsrFill(buf);
+			return 1;
+		}
+		return 0;
+	}
+#endif
+	send_pkt(FRAME_CMD_GROUP, FRAME_CMD_GROUP_LUGRP, &grp, 1);
+	ret = receive_pkt(vr_buf);
+	
+	if(ret <= 0){
+		return -1;
+	}
+	
+	if(vr_buf[2] != FRAME_CMD_GROUP){
+		return -1;
+	}
+	
+	if(buf != 0){
+		vr_buf[3] = 0;
+		for(int i=0; i<8; i++){
+			if(vr_buf[12]&(1<<i)){
+				vr_buf[3]++;
+			}
+		}
+		memcpy(buf, vr_buf+3, 11);
+		return 1;
+	}
+	
+	return 0;
+}
+#endif
+
+#if VR_ENABLE_SETTINGS
+/**
+    @brief reset system setting to default
+    @retval  0 --> success
+            -1 --> failed
+*/
+int VRCore :: restoreSystemSettings()
+{
+	int len;
+	send_pkt(FRAME_CMD_RESET_DEFAULT, 0, 0);
+	len = receive_pkt(vr_buf);
+	if(len<=0){
+		return -1;
+	}
+
+	if(vr_buf[2] != FRAME_CMD_RESET_DEFAULT){
+		return -1;
+	}
+
+	return 0;
+}
+#endif
+
+/**
+    @brief check system settings
+    @param buf --> return value
+            buf[0] --> baud rate. (0-9600 1-2400 2-4800 3-9600 4-19200 5-38400)
+            buf[1] --> output io mode(0-pulse 1-toggle 2-clear 3-set)
+            buf[2] --> pulse width level
+            buf[3] --> auto load(0,0xFF-disable 1-enable)
+            buf[4] --> Group control by external IO(0-disable 1-system group 2-user group)
+    @retval '>0' --> buf length
+            -1 --> failed
+*/
+int VRCore :: checkSystemSettings(uint8_t* buf)
+{
+	int len;
+	if(buf == 0){
+		return -1;
+	}
+	send_pkt(FRAME_CMD_CHECK_SYSTEM, 0, 0);
+	len = receive_pkt(vr_buf);
+	if(len<=0){
+		return -1;
+	}
+	
+	if(vr_buf[2] != FRAME_CMD_CHECK_SYSTEM){
+		return -1;
+	}
+
+	memcpy(buf, vr_buf+4, vr_buf[1]-3);
+	return vr_buf[1]-3;
+
+	return 0;
+}
+
+/**
+    @brief set module baud rate.
+    @param br --> module baud rate.(0-9600 1-2400 2-4800 3-9600 4-19200 5-38400)
+    @retval 0 --> success
+            -1 --> failed
+*/
+int VRCore :: setBaudRate(unsigned long br)
+{
+	uint8_t baud_rate;
+	int ret;
+	switch(br){
+		case 2400:
+			baud_rate = 1;
+			break;
+		case 4800:
+			baud_rate = 2;
+			break;
+		case 9600:
+			baud_rate = 0;
+			//baud_rate = 3;
+			break;
+		case 19200:
+			baud_rate = 4;
+			break;
+		case 38400:
+			baud_rate = 5;
+			break;
+		default:
+			return -1;
+			break;
+	}
+	
+	send_pkt(FRAME_CMD_SET_BR, baud_rate, 0, 0);
+	ret = receive_pkt(vr_buf);
+	if(ret<=0){
+		return -1;
+	}
+
+	if(vr_buf[2] != FRAME_CMD_SET_BR){
+		return -1;
+	}
+	/** module uses it after restart, try it first next time */
+	baudSave(br);
+	//DBGLN("VR Module Cleared");
+	return 0;
+	
+}
+
+/**
+    @brief find module baud rate. Each rate is probed with check system 
+           settings command(no side effect) and a timeout of the frame time 
+           plus VR_BAUD_PROBE_TURNAROUND. The last found rate is tried first, 
+           it is kept in EEPROM on AVR when VR_EEPROM_BAUD is defined. Link 
+           is left at the found rate.
+    @retval '>0' --> baud rate
+            -1 --> module not found
+*/
+long VRCore :: detectBaudRate()
+{
+	unsigned long last, rate;
+	uint16_t timeout;
+	int i, ret;
+	
+	last = baudLoad();
+	for(i=-1; i<5; i++){
+		if(i < 0){
+			rate = last;
+			if(rate == 0){
+				continue;
+			}
+		}else{
+			rate = pgm_read_dword(vr_baud_tab+i);
+			if(rate == last){
+				continue;
+			}
+		}
+		begin(rate);
+		/** 14 bytes on wire, 10 bits each */
+		timeout = 140*1000UL/rate + 1 + VR_BAUD_PROBE_TURNAROUND;
+		send_pkt(FRAME_CMD_CHECK_SYSTEM, 0, 0);
+		ret = receive_pkt(vr_buf, timeout);
+		if(ret > 0 && vr_buf[2] == FRAME_CMD_CHECK_SYSTEM){
+			if(rate != last){
+				baudSave(rate);
+			}
+			return rate;
+		}
+	}
+	return -1;
+}
+
+/** keep last known module baud rate */
+void VRCore :: baudSave(unsigned long br)
+{
+	uint8_t i;
+	for(i=0; i<5; i++){
+		if(pgm_read_dword(vr_baud_tab+i) == br){
+			break;
+		}
+	}
+	last_baud = br;
+#if defined(ARDUINO) && defined(__AVR__) && defined(VR_EEPROM_BAUD)
+	eeprom_update_byte((uint8_t *)VR_EEPROM_BAUD, i);
+#endif
+}
+
+/** last known module baud rate, 0 if unknown */
+unsigned long VRCore :: baudLoad()
+{
+#if defined(ARDUINO) && defined(__AVR__) && defined(VR_EEPROM_BAUD)
+	uint8_t i = eeprom_read_byte((const uint8_t *)VR_EEPROM_BAUD);
+	if(last_baud == 0 && i < 5){
+		last_baud = pgm_read_dword(vr_baud_tab+i);
+	}
+#endif
+	return last_baud;
+}
+
+#if VR_ENABLE_SETTINGS
+/**
+    @brief set module output IO mode.
+    @param mode --> module output IO mode.(must be PULSE, TOGGLE, SET, CLEAR)
+    @retval 0 --> success
+            -1 --> failed
+*/
+int VRCore :: setIOMode(io_mode_t mode)
+{
+	if(mode > 3){
+		return -1;
+	}
+	int ret;
+	
+	send_pkt(FRAME_CMD_SET_IOM, mode, 0, 0);
+	ret = receive_pkt(vr_buf);
+	if(ret<=0){
+		return -1;
+	}
+
+	if(vr_buf[2] != FRAME_CMD_SET_IOM){
+		return -1;
+	}
+	return 0;
+}
+
+/**
+    @brief resset module output IO.
+    @param ios --> output IO buffer.
+           len --> length of ios.
+    @retval 0 --> success
+            -1 --> failed
+*/
+int VRCore :: resetIO(uint8_t *ios, uint8_t len)
+{
+	int ret;
+	if(len == 1 && ios == 0){
+		send_pkt(FRAME_CMD_RESET_IO, 0xFF, 0, 0);
+	}else if(len != 0 && ios != 0){
+		send_pkt(FRAME_CMD_RESET_IO, ios, len);
+	}else{
+		return -1;
+	}
+
+	ret = receive_pkt(vr_buf);
+	if(ret<=0){
+		return -1;
+	}
+	if(vr_buf[2] != FRAME_CMD_RESET_IO){
+		return -1;
+	}
+	return 0;
+}
+
+/**
+    @brief set module pulse width(PULSE mode).
+    @param level --> pulse width level.(LEVEL0~LEVEL15)
+           len --> length of ios.
+    @retval 0 --> success
+            -1 --> failed
+*/
+int VRCore :: setPulseWidth(uint8_t level)
+{
+	int ret;
+	
+	if(level > VRCore::LEVEL15){
+		return -1;
+	}
+	
+	send_pkt(FRAME_CMD_SET_PW, level, 0, 0);
+	ret = receive_pkt(vr_buf);
+	if(ret<=0){
+		return -1;
+	}
+
+	if(vr_buf[2] != FRAME_CMD_SET_PW){
+		return -1;
+	}
+	return 0;
+}
+
+/**
+    @brief set autoload.
+    @param records --> record buffer.
+           len --> records length.
+    @retval 0 --> success
+            -1 --> failed
+*/
+int VRCore :: setAutoLoad(uint8_t *records, uint8_t len)
+{
+	int ret;
+	uint8_t map;
+	if(len == 0 && records == 0){
+		map = 0;
+	}else if(len != 0 && records != 0){
+		map = 0;
+		for(int i=0; i<len; i++){
+			map |= (1<<i);
+		}
+	}else{
+		return -1;
+	}
+	
+	send_pkt(FRAME_CMD_SET_AL, map, records, len);
+	ret = receive_pkt(vr_buf);
+	if(ret<=0){
+		return -1;
+	}
+	if(vr_buf[2] != FRAME_CMD_SET_AL){
+		return -1;
+	}
+	return 0;
+}
+
+/**
+    @brief set autoload records from a set, an empty set disables autoload.
+    @param records --> 0~7 records.
+    @retval 0 --> success
+            -1 --> failed
+*/
+int VRCore :: setAutoLoad(const RecordSet &records)
+{
+	uint8_t list[7], n;
+	if(records.count() > 7){
+		return -1;
+	}
+	n = records.toArray(list, 7);
+	return n ? setAutoLoad(list, n) : setAutoLoad();
+}
+
+/**
+    @brief disable autoload.
+    @param records --> record buffer.
+           len --> records length.
+    @retval 0 --> success
+            -1 --> failed
+*/
+int VRCore :: disableAutoLoad()
+{
+    return setAutoLoad();
+}
+#endif
+
+#if VR_ENABLE_TEST
+int VRCore :: test(uint8_t cmd, uint8_t *bsr)
+{
+	int len, i;
+	uint16_t timeout;
+	unsigned long start_millis;
+	switch(cmd){
+		case FRAME_CMD_TEST_READ:
+			vr_buf[0] = FRAME_CMD_TEST_READ;
+			send_pkt(FRAME_CMD_TEST, vr_buf, 1);
+			timeout = rtoGet(tx_cmd, tx_len);
+			start_millis = millis();
+			while(1){
+				len = receive_pkt(vr_buf);
+				if(len>0){
+					switch(vr_buf[2]){
+						case FRAME_CMD_TEST:
+							memcpy(bsr+vr_buf[3]*FRAME_TEST_CHUNK_SIZE, vr_buf+4, FRAME_TEST_CHUNK_SIZE);
+							if(vr_buf[3] == FRAME_TEST_CHUNK_NUM-1){
+								return 0;
+							}
+							break;
+						default:
+							return -1;
+							break;
+					}
+					start_millis = millis();
+					timeout = gapTimeout(tx_cmd, tx_len);
+				}
+				if(millis()-start_millis > timeout){
+					return -2;
+				}
+			}
+			break;
+		case FRAME_CMD_TEST_WRITE:
+			for(i=0; i<FRAME_TEST_CHUNK_NUM; i++){
+				vr_buf[0] = i;
+				memcpy(vr_buf+1, bsr+FRAME_TEST_CHUNK_SIZE*i, FRAME_TEST_CHUNK_SIZE);
+				send_pkt(FRAME_CMD_TEST, FRAME_CMD_TEST_WRITE, vr_buf, FRAME_TEST_CHUNK_SIZE+1);
+				timeout = rtoGet(tx_cmd, tx_len);
+				start_millis = millis();
+				while(1){
+					len = receive_pkt(vr_buf);
+					if(len>0){
+						if(vr_buf[2] == FRAME_CMD_TEST){
+							break;
+						}else{
+							return -1;
+						}
+						start_millis = millis();
+					}
+					if(millis()-start_millis > timeout){
+						return -2;
+					}
+				}
+			}
+			break;
+		default:
+			break;
+	}
+	return 0;
+}
+
+#if VR_ENABLE_ASYNC
+/** all chunks of recognizer buffer, bit map */
+#define VR_CHUNK_ALL							((1U<<FRAME_TEST_CHUNK_NUM)-1)
+
+typedef struct{
+	VRCore::chunk_sink_t sink;
+	VRCore::chunk_source_t source;		// set when chunks are compared
+	void *arg;
+	uint16_t done;
+	uint8_t stop;
+}snapshot_t;
+
+/** test read response, pass each chunk once to the sink, or compare it */
+static void snapshotChunk(int handle, int status, uint8_t *buf, int len, void *arg)
+{
+	snapshot_t *s = (snapshot_t *)arg;
+	uint8_t chunk[FRAME_TEST_CHUNK_SIZE];
+	uint8_t index;
+	(void)handle;
+	(void)status;
+	if(buf == 0 || buf[2] != FRAME_CMD_TEST || len < FRAME_TEST_CHUNK_SIZE+5 || s->stop){
+		return;
+	}
+	index = buf[3];
+	if(index >= FRAME_TEST_CHUNK_NUM || (s->done & (1U<<index))){
+		return;
+	}
+	if(s->source != 0){
+		if(s->source(index, chunk, s->arg) < 0){
+			s->stop = 1;
+		}else if(memcmp(chunk, buf+4, FRAME_TEST_CHUNK_SIZE) == 0){
+			s->done |= 1U<<index;
+		}
+		return;
+	}
+	if(s->sink(index, buf+4, s->arg) < 0){
+		s->stop = 1;
+		return;
+	}
+	s->done |= 1U<<index;
+}
+
+/** one test read request, chunks go to snapshotChunk() */
+void VRCore :: snapshotPass(void *ctx, bool late)
+{
+	uint8_t sub = FRAME_CMD_TEST_READ;
+	snapshot_t *s = (snapshot_t *)ctx;
+	
+	if(sendAsync(FRAME_CMD_TEST, &sub, 1, snapshotChunk, s, FRAME_TEST_CHUNK_NUM) < 0){
+		return;
+	}
+	while(process());
+	if(late || s->done != VR_CHUNK_ALL){
+		/** 
+		  module sends all chunks for every request, chunks of a timed out 
+		  request may still come. Let them pass before the next command.
+		*/
+		while(millis() - rx_millis <= (unsigned long)wireTime(FRAME_TEST_CHUNK_SIZE+5) + VR_RX_GAP){
+			process();
+		}
+	}
+}
+
+/**
+    @brief read recognizer buffer, chunks are passed to sink as they arrive, 
+           no 200 bytes buffer is needed. Module sends all chunks for one 
+           request, a lost chunk is taken from next request(VR_SNAPSHOT_RETRY 
+           requests at most), sink gets each index once, in any order.
+    @param sink --> chunk handler, index 0~FRAME_TEST_CHUNK_NUM-1.
+           arg --> user argument of sink.
+           ms --> transfer time, ms, optional.
+    @retval 0 --> success
+            '>0' --> number of chunks still missing
+            -1 --> sink stopped the transfer
+*/
+int VRCore :: snapshotRecognizer(chunk_sink_t sink, void *arg, unsigned long *ms)
+{
+	snapshot_t s;
+	uint8_t i, miss;
+	unsigned long start = millis();
+	
+	s.sink = sink;
+	s.source = 0;
+	s.arg = arg;
+	s.done = 0;
+	s.stop = 0;
+	for(i=0; i<VR_SNAPSHOT_RETRY && s.done != VR_CHUNK_ALL && !s.stop; i++){
+		snapshotPass(&s, i > 0);
+	}
+	if(ms != 0){
+		*ms = millis() - start;
+	}
+	if(s.stop){
+		return -1;
+	}
+	for(i=0, miss=0; i<FRAME_TEST_CHUNK_NUM; i++){
+		if(!(s.done & (1U<<i))){
+			miss++;
+		}
+	}
+	return miss;
+}
+
+/**
+    @brief write recognizer buffer, chunks are taken from source and written 
+           back to back(VR_PIPELINE_DEPTH frames ahead) instead of one by one. 
+           Acknowledges carry no chunk index, so after a failed write the 
+           module is read back and only chunks it does not hold are written 
+           again(VR_SNAPSHOT_RETRY passes at most).
+    @param source --> fills chunk index 0~FRAME_TEST_CHUNK_NUM-1, may be 
+                      called again for the same chunk.
+           arg --> user argument of source.
+           ms --> transfer time, ms, optional.
+    @retval 0 --> success
+            '>0' --> number of chunks not written
+            -1 --> source stopped the transfer
+*/
+int VRCore :: restoreRecognizer(chunk_source_t source, void *arg, unsigned long *ms)
+{
+	uint8_t data[FRAME_TEST_CHUNK_SIZE+2];
+	int8_t status[FRAME_TEST_CHUNK_NUM];
+	snapshot_t s;
+	uint8_t i, n, pass, miss, lost;
+	unsigned long start = millis();
+	
+	s.sink = 0;
+	s.source = source;
+	s.arg = arg;
+	s.done = 0;
+	s.stop = 0;
+	for(pass=0; pass<VR_SNAPSHOT_RETRY && s.done != VR_CHUNK_ALL && !s.stop; pass++){
+		/** a slot no command reached reads as not answered */
+		memset(status, VR_ASYNC_TIMEOUT, sizeof(status));
+		beginBatch(status, FRAME_TEST_CHUNK_NUM);
+		for(i=0, n=0, lost=0; i<FRAME_TEST_CHUNK_NUM; i++){
+			if(s.done & (1U<<i)){
+				continue;
+			}
+			data[0] = FRAME_CMD_TEST_WRITE;
+			data[1] = i;
+			if(source(i, data+2, arg) < 0){
+				s.stop = 1;
+				break;
+			}
+			if(sendAsync(FRAME_CMD_TEST, data, sizeof(data)) < 0){
+				/** not queued, the read back below finds what is missing */
+				lost = 1;
+				break;
+			}
+			n++;
+		}
+		endBatch();
+		for(i=0; i<n && status[i]==0; i++);
+		if(i == n && !lost && !s.stop){
+			s.done = VR_CHUNK_ALL;
+			break;
+		}
+		/** a lost frame shifts the acknowledges, compare with module */
+		s.done = 0;
+		snapshotPass(&s, true);
+	}
+	/** recognizer content changed behind the shadow */
+	invalidateRecognizer();
+	if(ms != 0){
+		*ms = millis() - start;
+	}
+	if(s.stop){
+		return -1;
+	}
+	for(i=0, miss=0; i<FRAME_TEST_CHUNK_NUM; i++){
+		if(!(s.done & (1U<<i))){
+			miss++;
+		}
+	}
+	return miss;
+}
+#endif
+#endif
+
+/**
+    @brief set floor and ceiling of adaptive timeouts.
+    @param floor --> shortest timeout, ms(VR_RTO_MIN by default).
+           ceiling --> longest timeout, also used before the first response 
+                       of a command class is measured(VR_RTO_MAX by default, 
+                       8000 at most).
+*/
+void VRCore :: setTimeoutLimits(uint16_t floor, uint16_t ceiling)
+{
+	if(floor == 0){
+		floor = 1;
+	}
+	if(ceiling > 8000){
+		ceiling = 8000;
+	}
+	if(ceiling < floor){
+		ceiling = floor;
+	}
+	rto_min = floor;
+	rto_max = ceiling;
+}
+
+/**
+    @brief get adaptive timeout of a command.
+    @param cmd --> command, FRAME_CMD_XXX.
+    @retval timeout, ms.
+*/
+uint16_t VRCore :: getTimeout(uint8_t cmd)
+{
+	return rtoGet(cmd, 0);
+}
+
+/**
+    @brief get smoothed round trip time of a command, wire time excluded.
+    @param cmd --> command, FRAME_CMD_XXX.
+    @retval round trip time, ms. 0 --> not measured yet.
+*/
+uint16_t VRCore :: getRoundTrip(uint8_t cmd)
+{
+	uint8_t c = rtoClass(cmd);
+	if(!(rto_valid & (1<<c))){
+		return 0;
+	}
+	return (rto_srtt[c]+4)>>3;
+}
+
+/** commands sharing module response time */
+uint8_t VRCore :: rtoClass(uint8_t cmd)
+{
+	if(cmd < FRAME_CMD_RESET_DEFAULT){
+		return 0;		// check
+	}else if(cmd < FRAME_CMD_TRAIN){
+		return 1;		// settings
+	}else if(cmd < FRAME_CMD_LOAD){
+		return 2;		// signature, training
+	}else if(cmd <= FRAME_CMD_GROUP){
+		return 3;		// recognizer, group
+	}
+	return 4;			// test
+}
+
+/** milliseconds to send bytes at current baud rate, rounded up */
+uint16_t VRCore :: wireTime(uint8_t bytes)
+{
+	if(baud == 0){
+		return 0;
+	}
+	return (bytes*10000UL + baud - 1)/baud;
+}
+
+/**
+    @brief timeout of a command, request on the wire + srtt + 4*rttvar, 
+           kept in [rto_min, rto_max].
+    @param cmd --> command.
+           len --> request frame length.
+*/
+uint16_t VRCore :: rtoGet(uint8_t cmd, uint8_t len)
+{
+	uint8_t c = rtoClass(cmd);
+	unsigned long rto;
+	if(!(rto_valid & (1<<c))){
+		return rto_max;
+	}
+	rto = wireTime(len) + (rto_srtt[c]>>3) + rto_var[c];
+	if(rto < rto_min){
+		rto = rto_min;
+	}
+	if(rto > rto_max){
+		rto = rto_max;
+	}
+	return rto;
+}
+
+/**
+    @brief timeout between the frames of a multi-frame response, the command 
+           timeout but VR_FRAME_GAP(VR_TEST_FRAME_GAP for test read) at least.
+    @param cmd --> command.
+           len --> request frame length.
+*/
+uint16_t VRCore :: gapTimeout(uint8_t cmd, uint8_t len)
+{
+	uint16_t rto = rtoGet(cmd, len);
+	uint16_t floor = cmd == FRAME_CMD_TEST ? VR_TEST_FRAME_GAP : VR_FRAME_GAP;
+	return rto > floor ? rto : floor;
+}
+
+/**
+    @brief a request is going out, time its response. Training waits for 
+           the user and is not measured.
+*/
+void VRCore :: rtoStart(uint8_t cmd, uint8_t len)
+{
+	rto_wait = cmd != FRAME_CMD_TRAIN && cmd != FRAME_CMD_SIG_TRAIN;
+	tx_cmd = cmd;
+	tx_len = len;
+	tx_millis = millis();
+}
+
+/** take a round trip sample from the received frame(vr_buf) */
+void VRCore :: rtoTrack()
+{
+	uint8_t c;
+	int m;
+	unsigned long rtt, wire;
+	
+	if(!rto_wait || (vr_buf[2] != tx_cmd && vr_buf[2] != FRAME_CMD_ERROR)){
+		return;
+	}
+	rto_wait = 0;
+	rto_lost = 0;
+	
+	/** module turnaround, both frames on the wire are excluded */
+	rtt = millis() - tx_millis;
+	wire = wireTime(tx_len) + wireTime(vr_buf[1]+2);
+	rtt = rtt > wire ? rtt - wire : 0;
+	if(rtt > rto_max){
+		rtt = rto_max;
+	}
+	
+	c = rtoClass(tx_cmd);
+	if(!(rto_valid & (1<<c))){
+		rto_srtt[c] = rtt<<3;
+		rto_var[c] = rtt<<1;
+		rto_valid |= 1<<c;
+		return;
+	}
+	/** srtt += (rtt-srtt)/8, rttvar += (|rtt-srtt|-rttvar)/4 */
+	m = (int)rtt - (rto_srtt[c]>>3);
+	rto_srtt[c] += m;
+	if(m < 0){
+		m = -m;
+	}
+	m -= rto_var[c]>>2;
+	rto_var[c] += m;
+}
+
+/**
+    @brief response is missing, double the timeout of the command. A late 
+           response of the last sent command is still awaited.
+*/
+void VRCore :: rtoBackoff(uint8_t cmd)
+{
+	uint8_t c = rtoClass(cmd);
+	unsigned long var;
+	if(rto_wait && cmd == tx_cmd){
+		if(rto_lost){
+			return;
+		}
+		rto_lost = 1;
+	}
+	if(!(rto_valid & (1<<c))){
+		return;
+	}
+	var = 2UL*rtoGet(cmd, 0) - (rto_srtt[c]>>3);
+	if(var > rto_max){
+		var = rto_max;
+	}
+	rto_var[c] = var;
+}
+
+#if VR_ENABLE_ASYNC
+/**
+    @brief check if a timed out asynchronous response can no longer arrive. 
+           Otherwise it would be taken as the response of the next command.
+*/
+bool VRCore :: rtoQuiet()
+{
+	if(rto_lost && rto_wait && millis()-tx_millis <= rtoGet(tx_cmd, tx_len)){
+		return false;
+	}
+	if(rto_lost){
+		rto_lost = 0;
+		rto_wait = 0;
+	}
+	return true;
+}
+
+/****************************************************************************/
+/*************************** ASYNCHRONOUS COMMANDS **************************/
+/**
+    @brief queue a command, return at once. The frame is sent when the module 
+           is idle, process() delivers the response to cb.
+           Do not call blocking functions while asynchronous commands are 
+           pending, they flush the receive buffer.
+    @param cmd --> command.
+           buf --> data area(subcommand included).
+           len --> length of buf(max VR_CMD_DATA_SIZE).
+           cb --> callback, called once for each response frame, the last one 
+                  with VR_ASYNC_DONE, optional.
+           arg --> user argument of cb.
+           frames --> number of response frames, fewer frames are accepted 
+                      when the module stays idle for timeout.
+           timeout --> idle time before the command fails(VR_ASYNC_TIMEOUT).
+                       VR_TIMEOUT_AUTO(default) follows measured response time.
+    @retval '>0' --> command handle.
+            -1 --> queue full or data too long.
+*/
+int VRCore :: sendAsync(uint8_t cmd, uint8_t *buf, uint8_t len, cmd_callback_t cb, void *arg, 
+					uint8_t frames, uint16_t timeout)
+{
+	cmd_t *c;
+	if(len > VR_CMD_DATA_SIZE){
+		return -1;
+	}
+	while(batch_on && cmdq_cnt >= VR_CMD_QUEUE_SIZE){
+		/** batch waits for room */
+		process();
+	}
+	if(cmdq_cnt >= VR_CMD_QUEUE_SIZE){
+		return -1;
+	}
+	c = cmdAt(cmdq_cnt);
+	cmdq_seq++;
+	if(cmdq_seq == 0){
+		cmdq_seq = 1;
+	}
+	c->handle = cmdq_seq;
+	c->cmd = cmd;
+	c->len = len;
+	if(len){
+		memcpy(c->data, buf, len);
+	}
+	c->frames = frames;
+	c->cnt = 0;
+	c->sent = 0;
+	c->batch = 0xFF;
+	if(batch_on){
+		c->batch = batch_cnt++;
+	}
+	c->timeout = timeout;
+	c->cb = cb;
+	c->arg = arg;
+	cmdq_cnt++;
+	
+	cmdSend();
+	return c->handle;
+}
+
+/**
+    @brief asynchronous load(), response is same as load().
+    @retval '>0' --> command handle.
+            -1 --> failed.
+*/
+int VRCore :: loadAsync(uint8_t *records, uint8_t len, cmd_callback_t cb, void *arg)
+{
+	if(len == 0 || len > 7){
+		return -1;
+	}
+	return sendAsync(FRAME_CMD_LOAD, records, len, cb, arg);
+}
+
+/**
+    @brief asynchronous clear().
+    @retval '>0' --> command handle.
+            -1 --> failed.
+*/
+int VRCore :: clearAsync(cmd_callback_t cb, void *arg)
+{
+	return sendAsync(FRAME_CMD_CLEAR, 0, 0, cb, arg);
+}
+
+/**
+    @brief asynchronous checkRecognizer(), response is same as checkRecognizer().
+    @retval '>0' --> command handle.
+            -1 --> failed.
+*/
+int VRCore :: checkRecognizerAsync(cmd_callback_t cb, void *arg)
+{
+	return sendAsync(FRAME_CMD_CHECK_BSR, 0, 0, cb, arg);
+}
+
+/**
+    @brief asynchronous checkRecord(). Check all records if records is 0, 
+           one frame for every 5 records.
+    @retval '>0' --> command handle.
+            -1 --> failed.
+*/
+int VRCore :: checkRecordAsync(uint8_t *records, uint8_t len, cmd_callback_t cb, void *arg)
+{
+	uint8_t all = 0xFF;
+	if(records == 0 && len == 0){
+		return sendAsync(FRAME_CMD_CHECK_TRAIN, &all, 1, cb, arg, 51);
+	}
+	if(records == 0){
+		return -1;
+	}
+	return sendAsync(FRAME_CMD_CHECK_TRAIN, records, len, cb, arg);
+}
+
+/**
+    @brief asynchronous setSignature(), 0 buf deletes the signature.
+    @retval '>0' --> command handle.
+            -1 --> failed.
+*/
+int VRCore :: setSignatureAsync(uint8_t record, const void *buf, uint8_t len, cmd_callback_t cb, void *arg)
+{
+	uint8_t data[11];
+	if(buf != 0 && len == 0){
+		len = strlen((char *)buf);
+	}
+	if(len > 10 || (buf == 0 && len != 0)){
+		return -1;
+	}
+	data[0] = record;
+	memcpy(data+1, buf, len);
+	return sendAsync(FRAME_CMD_SET_SIG, data, len+1, cb, arg);
+}
+
+/**
+    @brief asynchronous checkSignature().
+    @retval '>0' --> command handle.
+            -1 --> failed.
+*/
+int VRCore :: checkSignatureAsync(uint8_t record, cmd_callback_t cb, void *arg)
+{
+	return sendAsync(FRAME_CMD_CHECK_SIG, &record, 1, cb, arg);
+}
+
+#if VR_ENABLE_TRAIN
+/**
+    @brief asynchronous train(), prompts are passed to cb with VR_ASYNC_PROGRESS.
+    @retval '>0' --> command handle.
+            -1 --> failed.
+*/
+int VRCore :: trainAsync(uint8_t *records, uint8_t len, cmd_callback_t cb, void *arg)
+{
+	if(len == 0){
+		return -1;
+	}
+	return sendAsync(FRAME_CMD_TRAIN, records, len, cb, arg, 1, 8000);
+}
+
+/**
+    @brief asynchronous trainWithSignature(), prompts are passed to cb with 
+           VR_ASYNC_PROGRESS.
+    @retval '>0' --> command handle.
+            -1 --> failed.
+*/
+int VRCore :: trainWithSignatureAsync(uint8_t record, const void *buf, uint8_t len, cmd_callback_t cb, void *arg)
+{
+	uint8_t data[11];
+	if(buf == 0){
+		return -1;
+	}
+	if(len == 0){
+		len = strlen((char *)buf);
+	}
+	if(len > 10){
+		return -1;
+	}
+	data[0] = record;
+	memcpy(data+1, buf, len);
+	return sendAsync(FRAME_CMD_SIG_TRAIN, data, len+1, cb, arg, 1, 8000);
+}
+#endif
+
+#if VR_ENABLE_GROUP
+/**
+    @brief asynchronous loadSystemGroup().
+    @retval '>0' --> command handle.
+            -1 --> failed.
+*/
+int VRCore :: loadSystemGroupAsync(uint8_t grp, cmd_callback_t cb, void *arg)
+{
+	uint8_t data[2];
+	if(grp > 10){
+		return -1;
+	}
+	data[0] = FRAME_CMD_GROUP_LSGRP;
+	data[1] = grp;
+	return sendAsync(FRAME_CMD_GROUP, data, 2, cb, arg);
+}
+
+/**
+    @brief asynchronous loadUserGroup().
+    @retval '>0' --> command handle.
+            -1 --> failed.
+*/
+int VRCore :: loadUserGroupAsync(uint8_t grp, cmd_callback_t cb, void *arg)
+{
+	uint8_t data[2];
+	if(grp > GROUP7){
+		return -1;
+	}
+	data[0] = FRAME_CMD_GROUP_LUGRP;
+	data[1] = grp;
+	return sendAsync(FRAME_CMD_GROUP, data, 2, cb, arg);
+}
+#endif
+
+/**
+    @brief set callback for voice recognized frames received by process(), 
+           handle is 0, buf is same as vr_buf of recognize().
+*/
+void VRCore :: setRecognizeCallback(cmd_callback_t cb, void *arg)
+{
+	vr_cb = cb;
+	vr_cb_arg = arg;
+}
+
+/**
+    @brief drive asynchronous commands, call it in loop(). Never blocks.
+    @retval number of commands still pending.
+*/
+int VRCore :: process()
+{
+	int ret;
+	uint8_t i;
+	uint16_t timeout;
+	long cnt = rx_bytes;
+	cmd_t *c;
+	
+	cmdSend();
+	while((ret = poll()) != 0){
+		if(ret < 0){
+			continue;
+		}
+		if(vr_buf[2] == FRAME_CMD_VR){
+			if(vr_cb != 0){
+				vr_cb(0, VR_ASYNC_DONE, vr_buf, ret, vr_cb_arg);
+			}
+			continue;
+		}
+		/** oldest sent command expecting this frame */
+		for(i=0; i<cmdq_cnt; i++){
+			c = cmdAt(i);
+			if(!c->sent){
+				i = cmdq_cnt;
+				break;
+			}
+			if(cmdMatch(c) || vr_buf[2] == FRAME_CMD_ERROR){
+				break;
+			}
+			if(vr_buf[2] == FRAME_CMD_PROMPT && 
+				(c->cmd == FRAME_CMD_TRAIN || c->cmd == FRAME_CMD_SIG_TRAIN)){
+				break;
+			}
+		}
+		if(i == cmdq_cnt){
+			continue;
+		}
+		/** line is alive, responses of later commands are queued behind */
+		for(uint8_t j=0; j<cmdq_cnt && cmdAt(j)->sent; j++){
+			cmdAt(j)->start_millis = millis();
+		}
+		for(uint8_t j=0; j<i && vr_buf[2] == c->cmd; ){
+			if(cmdAt(j)->cmd == c->cmd && cmdAt(j)->cnt == 0){
+				/** responses come in order, older command lost its own */
+				trace(TRACE_TIMEOUT, c->cmd, 0);
+				cmdFinish(j, VR_ASYNC_TIMEOUT, 0, 0);
+				c = cmdAt(--i);
+			}else{
+				j++;
+			}
+		}
+		if(vr_buf[2] == FRAME_CMD_ERROR){
+			cmdFinish(i, VR_ASYNC_ERROR, vr_buf, ret);
+		}else if(vr_buf[2] == c->cmd){
+			c->cnt++;
+			if(c->cnt >= c->frames){
+				cmdFinish(i, VR_ASYNC_DONE, vr_buf, ret);
+			}else if(c->cb != 0){
+				c->cb(c->handle, VR_ASYNC_PROGRESS, vr_buf, ret, c->arg);
+			}
+		}else if(c->cb != 0){
+			c->cb(c->handle, VR_ASYNC_PROGRESS, vr_buf, ret, c->arg);
+		}
+	}
+	
+	if(rx_pend != 0 && rx_bytes != cnt){
+		/** a frame is coming, timeouts are idle time like receive_pkt() */
+		for(i=0; i<cmdq_cnt && cmdAt(i)->sent; i++){
+			cmdAt(i)->start_millis = millis();
+		}
+	}
+	for(i=0; i<cmdq_cnt; i++){
+		c = cmdAt(i);
+		if(!c->sent){
+			break;
+		}
+		timeout = c->timeout;
+		if(timeout == VR_TIMEOUT_AUTO){
+			timeout = c->cnt > 0 ? gapTimeout(c->cmd, c->len+3) : rtoGet(c->cmd, c->len+3);
+		}
+		if(millis() - c->start_millis > timeout){
+			if(c->cnt == 0 && c->timeout == VR_TIMEOUT_AUTO){
+				rtoBackoff(c->cmd);
+			}
+			if(c->cnt == 0){
+				trace(TRACE_TIMEOUT, c->cmd, rx_pend);
+			}
+			cmdFinish(i, c->cnt > 0 ? VR_ASYNC_DONE : VR_ASYNC_TIMEOUT, 0, 0);
+			break;
+		}
+	}
+	
+	return cmdq_cnt;
+}
+
+/**
+    @brief check if the link is in use, a frame is being received or a sent 
+           asynchronous command waits for response.
+*/
+bool VRCore :: isBusy()
+{
+	return rx_pend > rx_done || (cmdq_cnt != 0 && cmdAt(0)->sent);
+}
+
+/** send the head of the command queue if it is not sent yet */
+void VRCore :: cmdSend()
+{
+	uint8_t i;
+	cmd_t *c;
+	for(i=0; i<cmdq_cnt; i++){
+		c = cmdAt(i);
+		if(!c->sent){
+			break;
+		}
+	}
+	if(i == cmdq_cnt || i >= cmdq_depth){
+		return;
+	}
+	if(i != 0 && (cmdExclusive(c) || cmdExclusive(cmdAt(0)))){
+		/** multi-frame responses are not pipelined */
+		return;
+	}
+	if(rx_pend > rx_done || port->available()){
+		/** a frame is coming in, do not drop it */
+		return;
+	}
+	if(!port->isListening()){
+		/** response would be lost */
+		return;
+	}
+	if(!rtoQuiet()){
+		/** late response of a timed out command may come */
+		return;
+	}
+	send_pkt(c->cmd, c->data, c->len);
+	if(i != 0){
+		/** response time of a pipelined command is not its own */
+		rto_wait = 0;
+	}
+	c->sent = 1;
+	c->start_millis = millis();
+	/** next frame goes back to back */
+	cmdSend();
+}
+
+/** 
+    response in vr_buf belongs to c. Commands on records are told apart by 
+    the record the response echoes, a lost response does not shift the 
+    later ones.
+*/
+bool VRCore :: cmdMatch(cmd_t *c)
+{
+	if(vr_buf[2] != c->cmd || c->len == 0){
+		return vr_buf[2] == c->cmd;
+	}
+	switch(c->cmd){
+		case FRAME_CMD_CHECK_SIG:
+			/** record, length, signature */
+			return vr_buf[3] == c->data[0];
+		case FRAME_CMD_CHECK_TRAIN:
+			if(c->data[0] == 0xFF){
+				/** all records */
+				return true;
+			}
+			/** N, R0, STA0 ... */
+			return vr_buf[1] > 3 && vr_buf[4] == c->data[0];
+		case FRAME_CMD_LOAD:
+		case FRAME_CMD_SET_SIG:
+			/** N, R0, STA0 ... or 00, record, signature */
+			return vr_buf[1] > 3 && vr_buf[4] == c->data[0];
+		default:
+			return true;
+	}
+}
+
+/** commands with several response frames own the line */
+bool VRCore :: cmdExclusive(cmd_t *c)
+{
+	return c->frames != 1 || c->cmd == FRAME_CMD_TRAIN || c->cmd == FRAME_CMD_SIG_TRAIN;
+}
+
+/** remove the head of the command queue, then report it */
+void VRCore :: cmdFinish(uint8_t i, int status, uint8_t *buf, int len)
+{
+	cmd_t *c = cmdAt(i);
+	cmd_callback_t cb = c->cb;
+	void *arg = c->arg;
+	int handle = c->handle;
+	
+	if(c->batch < batch_size && batch_status != 0){
+		batch_status[c->batch] = status == VR_ASYNC_DONE ? 0 : status;
+	}
+	if(status != VR_ASYNC_DONE){
+		batch_fail++;
+	}
+	for(; i+1<cmdq_cnt; i++){
+		*cmdAt(i) = *cmdAt(i+1);
+	}
+	cmdq_cnt--;
+	if(cb != 0){
+		cb(handle, status, buf, len, arg);
+	}
+	cmdSend();
+}
+
+#if VR_ENABLE_TRAIN
+/****************************************************************************/
+/****************************** TRAIN SESSION *******************************/
+/** session states */
+#define VR_TRAIN_IDLE							(0)
+#define VR_TRAIN_RUN							(1)
+#define VR_TRAIN_CANCEL							(2)
+
+/**
+	@brief VRTrainSession class constructor.
+	@param vr --> module to train, its process() drives the session.
+*/
+VRTrainSession::VRTrainSession(VRCore &vr) : vr(&vr)
+{
+	records = 0;
+	sigs = 0;
+	len = 0;
+	cur = 0;
+	trained = 0;
+	state = VR_TRAIN_IDLE;
+	started = 0;
+	cb = 0;
+	arg = 0;
+}
+
+/**
+	@brief start training, return at once. Records are trained in turn, 
+           events are passed to cb from process() or run().
+	@param records --> records to train, kept by caller until EVENT_DONE.
+           len --> number of records.
+           cb --> event callback.
+           arg --> user argument of cb.
+           sigs --> signature of each record, 0 or a 0 entry trains without 
+                    signature, kept by caller until EVENT_DONE.
+	@retval 0 --> success.
+            -1 --> session running, no record or no room in command queue.
+*/
+int VRTrainSession :: begin(const uint8_t *records, uint8_t len, event_callback_t cb, void *arg, 
+						const char * const *sigs)
+{
+	if(state != VR_TRAIN_IDLE || records == 0 || len == 0){
+		return -1;
+	}
+	this->records = records;
+	this->sigs = sigs;
+	this->len = len;
+	this->cb = cb;
+	this->arg = arg;
+	cur = 0;
+	trained = 0;
+	state = VR_TRAIN_RUN;
+	next();
+	return state == VR_TRAIN_IDLE ? -1 : 0;
+}
+
+/**
+	@brief stop the session. The module has no cancel command, the record 
+           in training is finished or timed out by the module, then 
+           EVENT_DONE comes with VR_TRAIN_CANCELLED.
+*/
+void VRTrainSession :: cancel()
+{
+	if(state == VR_TRAIN_RUN){
+		state = VR_TRAIN_CANCEL;
+	}
+}
+
+/**
+	@brief drive the session, call it in loop() when nothing else calls 
+           process() of the module.
+	@retval 1 --> session running.
+            0 --> no session.
+*/
+int VRTrainSession :: run()
+{
+	vr->process();
+	return isActive();
+}
+
+/**
+	@brief check if a session is running, cancelled ones included until 
+           EVENT_DONE.
+*/
+bool VRTrainSession :: isActive()
+{
+	return state != VR_TRAIN_IDLE;
+}
+
+/**
+	@brief number of records trained(status 00 or F0) in the session.
+*/
+uint8_t VRTrainSession :: getTrained()
+{
+	return trained;
+}
+
+/** queue training of record cur, or end the session */
+void VRTrainSession :: next()
+{
+	int ret;
+	uint8_t record;
+	
+	if(state == VR_TRAIN_CANCEL || cur >= len){
+		emit(EVENT_DONE, state == VR_TRAIN_CANCEL ? VR_TRAIN_CANCELLED : 0);
+		state = VR_TRAIN_IDLE;
+		return;
+	}
+	record = records[cur];
+	started = 0;
+	if(sigs != 0 && sigs[cur] != 0){
+		ret = vr->trainWithSignatureAsync(record, sigs[cur], 0, onFrame, this);
+	}else{
+		ret = vr->trainAsync(&record, 1, onFrame, this);
+	}
+	if(ret < 0){
+		emit(EVENT_FAILED, VR_ASYNC_ERROR);
+		emit(EVENT_DONE, VR_ASYNC_ERROR);
+		state = VR_TRAIN_IDLE;
+	}
+}
+
+/** pass an event of record cur to the callback */
+void VRTrainSession :: emit(uint8_t type, int status, const uint8_t *text, uint8_t len)
+{
+	event_t ev;
+	if(cb == 0){
+		return;
+	}
+	ev.type = type;
+	ev.record = (type != EVENT_DONE && cur < this->len) ? records[cur] : 0xFF;
+	ev.status = status;
+	ev.trained = trained;
+	ev.text = text;
+	ev.len = len;
+	cb(ev, arg);
+}
+
+/** prompt and train response frames of the record in training */
+void VRTrainSession :: onFrame(int handle, int status, uint8_t *buf, int len, void *arg)
+{
+	VRTrainSession *s = (VRTrainSession *)arg;
+	(void)handle;
+	
+	if(status == VR_ASYNC_PROGRESS){
+		/** AA LEN 0A record text 0A */
+		if(buf[2] != FRAME_CMD_PROMPT || len < 5){
+			return;
+		}
+		if(!s->started){
+			s->started = 1;
+			s->emit(EVENT_STARTED, 0);
+		}
+		s->emit(EVENT_PROMPT, 0, buf+4, len-5);
+		return;
+	}
+	if(status != VR_ASYNC_DONE || buf == 0 || len < 7){
+		s->emit(EVENT_FAILED, status == VR_ASYNC_DONE ? VR_ASYNC_ERROR : status);
+	}else{
+		/** AA LEN cmd count record status [signature] 0A */
+		if(buf[5] == 0x00 || buf[5] == 0xF0){
+			s->trained++;
+		}
+		s->emit(EVENT_RESULT, buf[5], buf+6, len-7);
+	}
+	s->cur++;
+	s->next();
+}
+#endif
+
+/**
+    @brief set number of commands sent ahead of their responses. Responses 
+           are matched to commands by command code and order, and by the 
+           record they echo(check/set signature, check record, load). Keep 
+           1 on SoftwareSerial, it can not receive while it sends.
+    @param depth --> 1 ~ VR_CMD_QUEUE_SIZE, 1 is stop-and-wait.
+*/
+void VRCore :: setPipelineDepth(uint8_t depth)
+{
+	if(depth < 1){
+		depth = 1;
+	}
+	if(depth > VR_CMD_QUEUE_SIZE){
+		depth = VR_CMD_QUEUE_SIZE;
+	}
+	cmdq_depth = depth;
+}
+
+/**
+    @brief start a batch. Asynchronous commands queued until endBatch() are 
+           written back to back(VR_PIPELINE_DEPTH frames ahead, or at the 
+           depth set by setPipelineDepth() on a half duplex port such as 
+           SoftwareSerial), a full queue makes sendAsync() wait instead of 
+           failing.
+    @param status --> per command result in queued order, optional.
+                0 --> success
+               -1 --> module returned error
+               -2 --> timeout
+           size --> size of status.
+*/
+void VRCore :: beginBatch(int8_t *status, uint8_t size)
+{
+	batch_on = 1;
+	batch_cnt = 0;
+	batch_fail = 0;
+	batch_status = status;
+	batch_size = size;
+	batch_depth = cmdq_depth;
+	if(cmdq_depth < VR_PIPELINE_DEPTH && port->isFullDuplex()){
+		/** a frame sent over a response would break it on half duplex */
+		setPipelineDepth(VR_PIPELINE_DEPTH);
+	}
+	cmdSend();
+}
+
+/**
+    @brief flush the batch, wait until all queued commands are finished.
+    @retval '>=0' --> number of failed commands.
+*/
+int VRCore :: endBatch()
+{
+	while(process());
+	batch_on = 0;
+	batch_status = 0;
+	batch_size = 0;
+	cmdq_depth = batch_depth;
+	return batch_fail;
+}
+
+/****************************************************************************/
+/********************************* PROFILE **********************************/
+/**
+    @brief apply a module profile(see VRProfile.h) held in RAM, e.g. a file 
+           mapped by mmap() on a host. The profile is checked first, a broken 
+           one sends nothing. Sections go out through one batch, one frame 
+           each, the baud rate section last.
+    @param profile --> profile, VR_PROFILE_BEGIN ... VR_PROFILE_END.
+           size --> bytes available at profile.
+    @retval 0 --> success
+            '>0' --> number of sections the module refused or did not answer
+            -1 --> not a profile of VR_PROFILE_VERSION, or broken
+*/
+int VRCore :: applyProfile(const uint8_t *profile, uint16_t size)
+{
+	return profileApply(profile, size, false);
+}
+
+/**
+    @brief apply a module profile kept in flash(PROGMEM), same as 
+           applyProfile().
+*/
+int VRCore :: applyProfile_P(const uint8_t *profile)
+{
+	return profileApply(profile, 0xFFFF, true);
+}
+
+/** read one byte of a profile */
+static uint8_t profileByte(const uint8_t *profile, uint16_t pos, bool flash)
+{
+	return flash ? pgm_read_byte_near(profile+pos) : profile[pos];
+}
+
+/** check the profile(send 0), then send its sections(send 1) */
+int VRCore :: profileApply(const uint8_t *profile, uint16_t size, bool flash)
+{
+	uint8_t data[VR_CMD_DATA_SIZE];
+	uint8_t cmd, len, i, send, dirty = 0;
+	uint16_t pos;
+	unsigned long br = 0;
+	int fail = 0;
+	
+	if(profile == 0 || size < VR_PROFILE_HEAD+1){
+		return -1;
+	}
+	for(i=0; i<VR_PROFILE_HEAD; i++){
+		if(profileByte(profile, i, flash) != pgm_read_byte_near(vr_profile_head+i)){
+			return -1;
+		}
+	}
+	for(send=0; send<2; send++){
+		if(send){
+			beginBatch();
+		}
+		for(pos=VR_PROFILE_HEAD; ; pos+=2+len){
+			if(pos >= size){
+				return -1;
+			}
+			cmd = profileByte(profile, pos, flash);
+			if(cmd == VR_PROFILE_END){
+				break;
+			}
+			if(size - pos < 2 || br != 0){
+				/** baud rate section must be the last one */
+				return -1;
+			}
+			len = profileByte(profile, pos+1, flash);
+			if(len == 0 || len > VR_CMD_DATA_SIZE || size - pos - 2 < len){
+				return -1;
+			}
+			for(i=0; i<len; i++){
+				data[i] = profileByte(profile, pos+2+i, flash);
+			}
+			switch(cmd){
+				case FRAME_CMD_SET_SIG:
+				case FRAME_CMD_SET_AL:
+				case FRAME_CMD_SET_IOM:
+				case FRAME_CMD_SET_PW:
+					break;
+				case FRAME_CMD_GROUP:
+					if(data[0] != FRAME_CMD_GROUP_SUGRP){
+						return -1;
+					}
+					dirty = 1;
+					break;
+				case FRAME_CMD_TEST:
+					if(data[0] != FRAME_CMD_TEST_WRITE || len != FRAME_TEST_CHUNK_SIZE+2){
+						return -1;
+					}
+					dirty = 1;
+					break;
+				case FRAME_CMD_SET_BR:
+					/** module code, see VR_PROFILE_BAUD() */
+					switch(data[0]){
+						case 0: case 3: br = 9600; break;
+						case 1: br = 2400; break;
+						case 2: br = 4800; break;
+						case 4: br = 19200; break;
+						case 5: br = 38400; break;
+						default: return -1;
+					}
+					/** sent after the batch, setBaudRate() keeps it for detectBaudRate() */
+					continue;
+				default:
+					return -1;
+			}
+			if(send && sendAsync(cmd, data, len) < 0){
+				fail++;
+			}
+		}
+		if(send){
+			fail += endBatch();
+		}else{
+			br = 0;
+		}
+	}
+	if(dirty){
+		/** groups or recognizer changed behind the shadow */
+		invalidateRecognizer();
+	}
+	if(br != 0 && setBaudRate(br) < 0){
+		fail++;
+	}
+	return fail;
+}
+#endif
+
+/**flash operation function (strlen)*/
+int VRCore :: len(uint8_t *buf)
+{
+	int i=0;
+	while(pgm_read_byte_near(buf++)){
+		i++;
+	}
+	return i;
+}
+
+/**flash operation function (strcmp)*/
+int VRCore :: cmp(uint8_t *buf, uint8_t *bufcmp, int len  )
+{
+	int i;
+	for(i=0; i<len; i++){
+		if(buf[i] != pgm_read_byte_near(bufcmp+i)){
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/**flash operation function (strcpy)*/
+void VRCore :: cpy(char *buf, char * pbuf)
+{
+  int i=0;
+  while(pgm_read_byte_near(pbuf)){
+    buf[i] = pgm_read_byte_near(pbuf++);
+    i++;
+  }
+}
+
+/** ascending sort */
+void VRCore :: sort(uint8_t *buf, int len)
+{
+	int i, j;
+	uint8_t tmp;
+	for(i=0; i<len; i++){
+		for(j=i+1; j<len; j++){
+			if(buf[j] < buf[i]){
+				tmp = buf[i];
+				buf[i] = buf[j]; 
+				buf[j] = tmp;
+			}
+		}
+	}
+}
+
+/** remove duplicates */
+int VRCore :: cleanDup(uint8_t *des, uint8_t *buf, int len)
+{	
+	if(len<1){
+		return -1;
+	}
+	
+	RecordSet seen;
+	int i, j, k=0;
+	for(i=0; i<len; i++){
+		if(buf[i] < RecordSet::VR_RECORD_NUM){
+			if(seen.contains(buf[i])){
+				continue;
+			}
+			seen.add(buf[i]);
+		}else{
+			/** out of range values are rare, search them */
+			for(j=0; j<k && des[j]!=buf[i]; j++);
+			if(j<k){
+				continue;
+			}
+		}
+		des[k] = buf[i];
+		k++;
+	}
+	return k;
+}
+
+#if defined(ARDUINO)
+/**
+    @brief print buffer in HEX format, "AA 02 00 0A ". Prints with or
+           without DEBUG.
+    @param buf --> data to print.
+           len --> length of buf.
+           out --> output, Serial by default.
+    @retval length of buf.
+*/
+int VRCore :: writehex(uint8_t *buf, uint8_t len, Print &out)
+{
+	int i;
+	for(i=0; i<len; i++){
+		out.write(pgm_read_byte_near(hextab+((buf[i]&0xF0)>>4)));
+		out.write(pgm_read_byte_near(hextab+(buf[i]&0x0F)));
+		out.write(' ');
+	}
+	return len;
+}
+#endif
+
+/**
+    @brief send data packet in Voice Recognition module protocol format.
+    @param cmd --> command 
+           subcmd --> subcommand
+           buf --> data area
+           len --> length of buf
+*/
+void VRCore :: send_pkt(uint8_t cmd, uint8_t subcmd, uint8_t *buf, uint8_t len)
+{
+	txFlush();
+	rtoStart(cmd, len+5);
+	tx_bytes += len+5;
+	trace(TRACE_TX, cmd, len+5);
+	port->write(FRAME_HEAD);
+	port->write(len+3);
+	port->write(cmd);
+	port->write(subcmd);
+	port->write(buf, len);
+	port->write(FRAME_END);
+	port->flush();
+}
+
+/**
+    @brief send data packet in Voice Recognition module protocol format.
+    @param cmd --> command 
+           buf --> data area
+           len --> length of buf
+*/
+void VRCore :: send_pkt(uint8_t cmd, uint8_t *buf, uint8_t len)
+{
+	txFlush();
+	rtoStart(cmd, len+4);
+	tx_bytes += len+4;
+	trace(TRACE_TX, cmd, len+4);
+	port->write(FRAME_HEAD);
+	port->write(len+2);
+	port->write(cmd);
+	port->write(buf, len);
+	port->write(FRAME_END);
+	port->flush();
+}
+
+/**
+    @brief send data packet in Voice Recognition module protocol format.
+    @param buf --> data area
+           len --> length of buf
+*/
+void VRCore :: send_pkt(uint8_t *buf, uint8_t len)
+{
+	txFlush();
+	rtoStart(buf[0], len+3);
+	tx_bytes += len+3;
+	trace(TRACE_TX, buf[0], len+3);
+	port->write(FRAME_HEAD);
+	port->write(len+1);
+	port->write(buf, len);
+	port->write(FRAME_END);
+	port->flush();
+}
+
+/**
+    @brief receive a valid data packet in Voice Recognition module protocol format.
+           Blocking wrapper of poll().
+    @param buf --> return value buffer.
+           timeout --> time of reveiving, restarted by every received byte.
+                       0 means only take the bytes already received.
+                       VR_TIMEOUT_AUTO means a few round trip times of the 
+                       last sent command.
+           Bad bytes are skipped, receiver resyncs on next frame.
+    @retval '>0' --> success, packet lenght(length of all data in buf)
+            '<0' --> failed
+*/
+int VRCore :: receive_pkt(uint8_t *buf, uint16_t timeout)
+{
+	int ret;
+	long cnt;
+	unsigned long start_millis;
+	bool adaptive = false;
+	
+	if(timeout == VR_TIMEOUT_AUTO){
+		timeout = rtoGet(tx_cmd, tx_len);
+		adaptive = true;
+	}
+	start_millis = millis();
+	while(1){
+		cnt = rx_bytes;
+		ret = poll();
+		if(ret > 0){
+			if(buf != vr_buf){
+				memcpy(buf, vr_buf, ret);
+			}
+			return ret;
+		}
+		if(rx_bytes != cnt && rx_pend != 0){
+			/** frame is coming, noise does not hold the wait */
+			start_millis = millis();
+		}
+		if(millis()-start_millis >= timeout){
+			if(adaptive && rx_pend == 0 && rto_wait && !rto_lost && 
+				(rto_valid & (1<<rtoClass(tx_cmd)))){
+				/** 
+				  no response, lost frame or slower module. Wait once more 
+				  with doubled timeout, a late response is never taken as 
+				  the response of next command.
+				*/
+				rtoBackoff(tx_cmd);
+				timeout = rtoGet(tx_cmd, tx_len);
+				start_millis = millis();
+				continue;
+			}
+			break;
+		}
+	}
+	
+	if(timeout == 0){
+		/** keep the partial frame, next call continues it */
+		return -1;
+	}
+	if(rto_wait || rx_pend != 0){
+		trace(TRACE_TIMEOUT, tx_cmd, rx_pend);
+	}
+	rto_wait = 0;
+	rto_lost = 0;
+	if(rx_pend == 0){
+		return -1;
+	}
+	/** incomplete frame */
+	ret = rx_pend < 2 ? -1 : -4;
+	rxDiscard(rx_pend);
+	return ret;
+}
+
+/**
+    @brief take the received bytes into the frame receiver, never blocks.
+           Frame is assembled in vr_buf, HEAD -> LEN -> body -> END. Bad 
+           bytes are discarded and the receiver slides to the next FRAME_HEAD, 
+           a frame with wrong FRAME_END or stopped for VR_RX_GAP is rescanned 
+           from its next FRAME_HEAD, so a glitch costs at most the frame it 
+           hits.
+    @retval '>0' --> a complete frame is in vr_buf, frame length. The frame 
+                     stays valid until the next call.
+            0 --> no complete frame yet.
+            '<0' --> bytes discarded, receiver is resyncing. Call again.
+                -2 --> frame head error.
+                -3 --> frame length error.
+                -4 --> frame end error.
+*/
+int VRCore :: poll()
+{
+	int ch;
+	uint8_t k;
+	
+	if(rx_done){
+		/** drop the frame returned by last call */
+		rx_pend -= rx_done;
+		if(rx_pend){
+			memmove(vr_buf, vr_buf+rx_done, rx_pend);
+		}
+		rx_done = 0;
+	}
+	while(1){
+		if(rx_cnt == rx_pend){
+			if((ch = port->read()) < 0){
+				if(rx_pend && millis()-rx_millis > VR_RX_GAP){
+					/** frame stopped, a frame may start inside it */
+					for(k=1; k<rx_pend && vr_buf[k]!=FRAME_HEAD; k++);
+					rxDiscard(k);
+					return -4;
+				}
+				return 0;
+			}
+			rx_millis = millis();
+			rx_bytes++;
+			vr_buf[rx_pend++] = ch;
+		}
+		/** bytes left by a resync are taken again before new ones */
+		ch = vr_buf[rx_cnt++];
+		if(rx_cnt == 1){
+			if(ch != FRAME_HEAD){
+				rxDiscard(1);
+				return -2;
+			}
+		}else if(rx_cnt == 2){
+			if(ch < 2 || ch+2 > (int)sizeof(vr_buf)){
+				/** head was noise, length byte may be next head */
+				rxDiscard(1);
+				return -3;
+			}
+		}else if(rx_cnt == vr_buf[1]+2){
+			if(ch != FRAME_END){
+				/** length was wrong, restart from next head in the frame */
+				for(k=1; k<rx_cnt && vr_buf[k]!=FRAME_HEAD; k++);
+				rxDiscard(k);
+				return -4;
+			}
+			rx_cnt = 0;
+			rx_done = vr_buf[1]+2;
+			if(rx_lost){
+				rx_resyncs++;
+				rx_lost = 0;
+			}
+			if(vr_buf[2] == FRAME_CMD_ERROR){
+				trace(TRACE_ERROR, tx_cmd, vr_buf[3]);
+			}else{
+				trace(TRACE_RX, vr_buf[2], rx_done);
+			}
+#if VR_ENABLE_SHADOW
+			bsrTrack();
+#endif
+#if VR_ENABLE_RECORD_CACHE
+			recTrack();
+#endif
+#if VR_ENABLE_SIG_CACHE
+			sigTrack();
+#endif
+			rtoTrack();
+			return rx_done;
+		}
+	}
+}
+
+/** 
+    drop stale bytes before a frame is sent, unless they may be responses 
+    of asynchronous commands in flight.
+*/
+void VRCore :: txFlush()
+{
+#if VR_ENABLE_ASYNC
+	if(cmdq_cnt != 0 && cmdAt(0)->sent){
+		return;
+	}
+#endif
+	resetReceiver();
+}
+
+/** drop the first len bytes of receiver, restart frame assembly */
+void VRCore :: rxDiscard(uint8_t len)
+{
+	trace(TRACE_DISCARD, vr_buf[0], len);
+	rx_pend -= len;
+	if(rx_pend){
+		memmove(vr_buf, vr_buf+len, rx_pend);
+	}
+	rx_cnt = 0;
+	rx_discarded += len;
+	rx_lost = 1;
+}
+
+/**
+    @brief drop received bytes and restart the frame receiver.
+*/
+void VRCore :: resetReceiver()
+{
+	while(port->available()){
+		port->read();// replace flush();
+	}
+	rx_cnt = 0;
+	rx_pend = 0;
+	rx_done = 0;
+}
+
+/**
+    @brief clear link quality counters.
+*/
+void VRCore :: resetLinkStats()
+{
+	tx_bytes = 0;
+	rx_bytes = 0;
+	rx_discarded = 0;
+	rx_resyncs = 0;
+}
+
+/**
+    @brief take the oldest event of the trace.
+    @param ev --> event, return value.
+    @retval 1 --> success
+            0 --> trace is empty
+*/
+int VRCore :: readTrace(trace_t *ev)
+{
+#if VR_TRACE_SIZE > 0
+	if(trace_cnt == 0){
+		return 0;
+	}
+	*ev = trace_buf[(uint8_t)(trace_head-trace_cnt) & (VR_TRACE_SIZE-1)];
+	trace_cnt--;
+	return 1;
+#else
+	(void)ev;
+	return 0;
+#endif
+}
+
+/**
+    @brief drop all events of the trace.
+*/
+void VRCore :: clearTrace()
+{
+#if VR_TRACE_SIZE > 0
+	trace_head = 0;
+	trace_cnt = 0;
+#endif
+	trace_lost = 0;
+}
+
+#if defined(ARDUINO)
+/**
+    @brief print and drop all events of the trace, one line for each event.
+           Call it when the link is idle, printing blocks.
+    @param out --> output, e.g. Serial.
+*/
+void VRCore :: dumpTrace(Print &out)
+{
+	trace_t ev;
+	if(trace_lost){
+		out.print(trace_lost);
+		out.println(F(" events lost"));
+		trace_lost = 0;
+	}
+	while(readTrace(&ev)){
+		out.print(ev.ms);
+		switch(ev.event){
+			case TRACE_TX:
+				out.print(F("\tTX\t"));
+				break;
+			case TRACE_RX:
+				out.print(F("\tRX\t"));
+				break;
+			case TRACE_ERROR:
+				out.print(F("\tERROR\t"));
+				break;
+			case TRACE_TIMEOUT:
+				out.print(F("\tTIMEOUT\t"));
+				break;
+			case TRACE_DISCARD:
+				out.print(F("\tDISCARD\t"));
+				break;
+		}
+		out.print(ev.cmd, HEX);
+		out.print('\t');
+		out.println(ev.val);
+	}
+}
+#endif
+
+/**
+    @brief receive data .
+    @param buf --> return value buffer.
+           len --> length expect to receive.
+           timeout --> time of reveiving
+    @retval number of received bytes, 0 means no data received.
+*/
+int VRCore :: receive(uint8_t *buf, int len, uint16_t timeout)
+{
+  int read_bytes = 0;
+  int ret;
+  unsigned long start_millis;
+  
+  while (read_bytes < len) {
+    start_millis = millis();
+    do {
+      ret = port->read();
+      if (ret >= 0) {
+        break;
+     }
+    } while( (millis()- start_millis ) < timeout);
+    
+    if (ret < 0) {
+      return read_bytes;
+    }
+    buf[read_bytes] = (char)ret;
+    read_bytes++;
+  }
+  
+  return read_bytes;
+}
@@ -1,202 +1,769 @@
-/**
-  ******************************************************************************
-  * @file    VoiceRecognitionV2.h
-  * @author  Elechouse Team
-  * @version V1.0
-  * @date    2013-6-6
-  * @brief   This file provides all the VoiceRecognitionV2 firmware functions.
-  ******************************************************************************
-    @note
-         This driver is for elechouse Voice Recognition V2 Module(LINKS here)
-  ******************************************************************************
-  * @section  HISTORY
-  
-    V1.0    Initial version.
-  
-  ******************************************************************************
-  * @attention
-  *
-  * THE PRESENT FIRMWARE WHICH IS FOR GUIDANCE ONLY AIMS AT PROVIDING CUSTOMERS
-  * WITH CODING INFORMATION REGARDING THEIR PRODUCTS IN ORDER FOR THEM TO SAVE
-  * TIME. AS A RESULT, ELECHOUSE SHALL NOT BE HELD LIABLE FOR ANY
-  * DIRECT, INDIRECT OR CONSEQUENTIAL DAMAGES WITH RESPECT TO ANY CLAIMS ARISING
-  * FROM THE CONTENT OF SUCH FIRMWARE AND/OR THE USE MADE BY CUSTOMERS OF THE
-  * CODING INFORMATION CONTAINED HEREIN IN CONNECTION WITH THEIR PRODUCTS.
-  *
-  * <h2><center>&copy; COPYRIGHT 2013 ELECHOUSE</center></h2>
-  ******************************************************************************
-  */
-  
-#if ARDUINO >= 100
- #include "Arduino.h"
-#else
- #include "WProgram.h"
-#endif
-
-#include "wiring_private.h"
-
-#include "SoftwareSerial.h"
-#include <avr/pgmspace.h>
-
-#define DEBUG
-
-#ifdef DEBUG
-#define DBGSTR(message)     Serial.print(message)
-#define DBGBUF(buf, len)	Serial.write(buf, len)
-#define DBGLN(message)		Serial.println(message)
-#define DBGFMT(msg, fmt)	Serial.print(msg, fmt)
-#define DBGCHAR(c)			Serial.write(c)
-#else
-#define DBG(message)
-#endif // DEBUG
-
-#define VR_DEFAULT_TIMEOUT						(1000)
-
-/***************************************************************************/
-#define FRAME_HEAD							(0xAA)
-#define FRAME_END							(0x0A)
-
-/***************************************************************************/
-#define FRAME_CMD_CHECK_SYSTEM				(0x00)
-#define FRAME_CMD_CHECK_BSR					(0x01)
-#define FRAME_CMD_CHECK_TRAIN				(0x02)
-#define FRAME_CMD_CHECK_SIG					(0x03)
-
-#define FRAME_CMD_RESET_DEFAULT				(0x10)	//reset configuration
-#define FRAME_CMD_SET_BR					(0x11)	//baud rate
-#define FRAME_CMD_SET_IOM					(0x12)	//IO mode
-#define FRAME_CMD_SET_PW					(0x13)	//pulse width
-#define FRAME_CMD_RESET_IO					(0x14)	// reset IO OUTPUT					
-#define FRAME_CMD_SET_AL					(0x15)	// Auto load
-
-#define FRAME_CMD_TRAIN						(0x20)
-#define FRAME_CMD_SIG_TRAIN					(0x21)
-#define FRAME_CMD_SET_SIG					(0x22)
-
-#define FRAME_CMD_LOAD						(0x30)	//Load N records
-#define FRAME_CMD_CLEAR						(0x31)	//Clear BSR buffer					
-#define FRAME_CMD_GROUP						(0x32)  //
-	#define FRAME_CMD_GROUP_SET							(0x00)  //
-	#define FRAME_CMD_GROUP_SUGRP						(0x01)  //
-	#define FRAME_CMD_GROUP_LSGRP						(0x02)  //
-	#define FRAME_CMD_GROUP_LUGRP						(0x03)  //
-	#define FRAME_CMD_GROUP_CUGRP						(0x04)  //
-
-#define FRAME_CMD_TEST						(0xEE)
-	#define FRAME_CMD_TEST_READ							(0x01)	
-	#define FRAME_CMD_TEST_WRITE						(0x00)	
-
-
-#define FRAME_CMD_VR						(0x0D)	//Voice recognized
-#define FRAME_CMD_PROMPT					(0x0A)
-#define FRAME_CMD_ERROR						(0xFF)
-
-/***************************************************************************/
-// #define FRAME_ERR_UDCMD						(0x00)
-// #define FRAME_ERR_LEN						(0x01)
-// #define FRAME_ERR_DATA						(0x02)
-// #define FRAME_ERR_SUBCMD					(0x03)
-
-// //#define FRAME_ERR_
-// #define FRAME_STA_SUCCESS					(0x00)
-// #define FRAME_STA_FAILED					(0xFF)
-/***************************************************************************/
-
-
-class VR : public SoftwareSerial{
-public:
-	VR(uint8_t receivePin, uint8_t transmitPin);
-	
-	static VR* getInstance() {
-	   return instance;
-	}
-	
-	typedef enum{
-		PULSE = 0,
-		TOGGLE = 1,
-		SET = 2, 
-		CLEAR = 3
-	}io_mode_t;
-	
-	typedef enum{
-		LEVEL0 = 0,
-		LEVEL1,
-		LEVEL2, 
-		LEVEL3,
-		LEVEL4,
-		LEVEL5,
-		LEVEL6,
-		LEVEL7,
-		LEVEL8,
-		LEVEL9,
-		LEVEL10,
-		LEVEL11,
-		LEVEL12,
-		LEVEL13,
-		LEVEL14,
-		LEVEL15,
-	}pulse_width_level_t;
-	
-	typedef enum{
-		GROUP0 = 0,
-		GROUP1,
-		GROUP2,
-		GROUP3,
-		GROUP4,
-		GROUP5,
-		GROUP6,
-		GROUP7,
-		GROUP_ALL = 0xFF,
-	}group_t;
-	
-	int setBaudRate(unsigned long br);
-	int setIOMode(io_mode_t mode);
-	int resetIO(uint8_t *ios=0, uint8_t len=1);
-	int setPulseWidth(uint8_t level);
-	int setAutoLoad(uint8_t *records=0, uint8_t len = 0);
-    int disableAutoLoad();
-	int restoreSystemSettings();
-	int checkSystemSettings(uint8_t* buf);
-	int recognize(uint8_t *buf, int timeout = VR_DEFAULT_TIMEOUT);
-	int train(uint8_t *records, uint8_t len=1, uint8_t *buf = 0);
-	int train(uint8_t record, uint8_t *buf = 0);
-	int trainWithSignature(uint8_t record, const void *buf, uint8_t len=0, uint8_t *retbuf = 0);
-	int load(uint8_t *records, uint8_t len=1, uint8_t *buf = 0);
-	int load(uint8_t record, uint8_t *buf = 0);
-	int clear();
-	int setSignature(uint8_t record, const void *buf=0, uint8_t len=0);
-	int deleteSignature(uint8_t record);
-    
-	int checkSignature(uint8_t record, uint8_t *buf);
-	int checkRecognizer(uint8_t *buf);
-	int checkRecord(uint8_t *buf, uint8_t *records = 0, uint8_t len = 0);
-	
-	/** group control */
-	int setGroupControl(uint8_t ctrl);
-	int checkGroupControl();
-	int setUserGroup(uint8_t grp, uint8_t *records, uint8_t len);
-	int checkUserGroup(uint8_t grp, uint8_t *buf);
-	int loadSystemGroup(uint8_t grp, uint8_t *buf=0);
-	int loadUserGroup(uint8_t grp, uint8_t *buf=0);
-	
-	int test(uint8_t cmd, uint8_t *bsr);
-	
-	int writehex(uint8_t *buf, uint8_t len);
-	
-/***************************************************************************/
-	/** low level */
-	int len(uint8_t *buf);
-	int cmp(uint8_t *buf, uint8_t *bufcmp, int len  );
-	void cpy(char *buf,  char * pbuf);
-	void sort(uint8_t *buf, int len);
-	int cleanDup(uint8_t *des, uint8_t *buf, int len);
-	void send_pkt(uint8_t *buf, uint8_t len);
-	void send_pkt(uint8_t cmd, uint8_t *buf, uint8_t len);
-	void send_pkt(uint8_t cmd, uint8_t subcmd, uint8_t *buf, uint8_t len);
-	int receive(uint8_t *buf, int len, uint16_t timeout = VR_DEFAULT_TIMEOUT);
-	int receive_pkt(uint8_t *buf, uint16_t timeout = VR_DEFAULT_TIMEOUT);
-/***************************************************************************/
-private:
-	static VR*  instance;
-};
-
+/**
+  ******************************************************************************
+  * @file    VoiceRecognitionV2.h
+  * @author  Elechouse Team
+  * @version V1.0
+  * @date    2013-6-6
+  * @brief   This file provides all the VoiceRecognitionV2 firmware functions.
+  ******************************************************************************
+    @note
+         This driver is for elechouse Voice Recognition V2 Module(LINKS here)
+  ******************************************************************************
+  * @section  HISTORY
+  
+    V1.0    Initial version.
+  
+  ******************************************************************************
+  * @attention
+  *
+  * THE PRESENT FIRMWARE WHICH IS FOR GUIDANCE ONLY AIMS AT PROVIDING CUSTOMERS
+  * WITH CODING INFORMATION REGARDING THEIR PRODUCTS IN ORDER FOR THEM TO SAVE
+  * TIME. AS A RESULT, ELECHOUSE SHALL NOT BE HELD LIABLE FOR ANY
+  * DIRECT, INDIRECT OR CONSEQUENTIAL DAMAGES WITH RESPECT TO ANY CLAIMS ARISING
+  * FROM THE CONTENT OF SUCH FIRMWARE AND/OR THE USE MADE BY CUSTOMERS OF THE
+  * CODING INFORMATION CONTAINED HEREIN IN CONNECTION WITH THEIR PRODUCTS.
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 ELECHOUSE</center></h2>
+  ******************************************************************************
+  */
+  
+#ifndef __VOICE_RECOGNITION_V3_H
+#define __VOICE_RECOGNITION_V3_H
+
+#if defined(ARDUINO)
+ #if ARDUINO >= 100
+  #include "Arduino.h"
+ #else
+  #include "WProgram.h"
+ #endif
+
+ #include "wiring_private.h"
+
+ #include "SoftwareSerial.h"
+ #include <avr/pgmspace.h>
+ #if defined(__AVR__)
+  #include <avr/eeprom.h>
+ #endif
+#else
+ /** host build, see VRPosixTransport.h */
+ #include <stdint.h>
+ #include <stddef.h>
+ #include <string.h>
+ #define PROGMEM
+ #define pgm_read_byte_near(addr)			(*(const uint8_t *)(addr))
+ #define pgm_read_dword(addr)				(*(const uint32_t *)(addr))
+ #define pgm_read_ptr(addr)					(*(void * const *)(addr))
+ #define PSTR(s)								(s)
+ #define memcmp_P(a, b, n)					memcmp(a, b, n)
+ #define strlen_P(s)							strlen(s)
+ unsigned long millis();
+#endif
+
+#include "VRConfig.h"
+#include "VRTransport.h"
+#include "VRRecordSet.h"
+
+#if defined(DEBUG) && defined(ARDUINO)
+#define DBGSTR(message)     Serial.print(message)
+#define DBGBUF(buf, len)	Serial.write(buf, len)
+#define DBGLN(message)		Serial.println(message)
+#define DBGFMT(msg, fmt)	Serial.print(msg, fmt)
+#define DBGCHAR(c)			Serial.write(c)
+#else
+#define DBGSTR(message)
+#define DBGBUF(buf, len)
+#define DBGLN(message)
+#define DBGFMT(msg, fmt)
+#define DBGCHAR(c)
+#endif // DEBUG
+
+/** timeout taken from the measured round trip time of the command */
+#define VR_TIMEOUT_AUTO							(0xFFFF)
+/** command classes with their own round trip time estimator */
+#define VR_RTO_CLASSES							(5)
+
+/** signature cache layout: magic, VR_SIG_CACHE_LEN, stamp(2 bytes), then 80 
+    slots of length(0xFF: unknown) + signature */
+#define VR_SIG_CACHE_HEAD						(4)
+#define VR_SIG_CACHE_SLOT						(VR_SIG_CACHE_LEN+1)
+#define VR_SIG_CACHE_SIZE						(VR_SIG_CACHE_HEAD+80*VR_SIG_CACHE_SLOT)
+
+/** module profile layout(VRProfile.h): 'V' 'R' 'P' version, sections of 
+    command, length, frame data, then VR_PROFILE_END */
+#define VR_PROFILE_VERSION						(1)
+#define VR_PROFILE_HEAD							(4)
+#define VR_PROFILE_BEGIN						'V', 'R', 'P', VR_PROFILE_VERSION
+#define VR_PROFILE_END							(0x00)
+
+/** status passed to asynchronous command callbacks */
+#define VR_ASYNC_DONE							(0)
+#define VR_ASYNC_PROGRESS						(1)
+#define VR_ASYNC_ERROR							(-1)
+#define VR_ASYNC_TIMEOUT						(-2)
+
+/** EVENT_DONE status of VRTrainSession stopped by cancel() */
+#define VR_TRAIN_CANCELLED						(1)
+
+/***************************************************************************/
+#define FRAME_HEAD							(0xAA)
+#define FRAME_END							(0x0A)
+
+/***************************************************************************/
+#define FRAME_CMD_CHECK_SYSTEM				(0x00)
+#define FRAME_CMD_CHECK_BSR					(0x01)
+#define FRAME_CMD_CHECK_TRAIN				(0x02)
+#define FRAME_CMD_CHECK_SIG					(0x03)
+
+#define FRAME_CMD_RESET_DEFAULT				(0x10)	//reset configuration
+#define FRAME_CMD_SET_BR					(0x11)	//baud rate
+#define FRAME_CMD_SET_IOM					(0x12)	//IO mode
+#define FRAME_CMD_SET_PW					(0x13)	//pulse width
+#define FRAME_CMD_RESET_IO					(0x14)	// reset IO OUTPUT					
+#define FRAME_CMD_SET_AL					(0x15)	// Auto load
+
+#define FRAME_CMD_TRAIN						(0x20)
+#define FRAME_CMD_SIG_TRAIN					(0x21)
+#define FRAME_CMD_SET_SIG					(0x22)
+
+#define FRAME_CMD_LOAD						(0x30)	//Load N records
+#define FRAME_CMD_CLEAR						(0x31)	//Clear BSR buffer					
+#define FRAME_CMD_GROUP						(0x32)  //
+	#define FRAME_CMD_GROUP_SET							(0x00)  //
+	#define FRAME_CMD_GROUP_SUGRP						(0x01)  //
+	#define FRAME_CMD_GROUP_LSGRP						(0x02)  //
+	#define FRAME_CMD_GROUP_LUGRP						(0x03)  //
+	#define FRAME_CMD_GROUP_CUGRP						(0x04)  //
+
+#define FRAME_CMD_TEST						(0xEE)
+	#define FRAME_CMD_TEST_READ							(0x01)	
+	#define FRAME_CMD_TEST_WRITE						(0x00)	
+	/** recognizer buffer is moved in chunks */
+	#define FRAME_TEST_CHUNK_SIZE						(20)
+	#define FRAME_TEST_CHUNK_NUM						(10)
+
+
+#define FRAME_CMD_VR						(0x0D)	//Voice recognized
+#define FRAME_CMD_PROMPT					(0x0A)
+#define FRAME_CMD_ERROR						(0xFF)
+
+/***************************************************************************/
+// #define FRAME_ERR_UDCMD						(0x00)
+// #define FRAME_ERR_LEN						(0x01)
+// #define FRAME_ERR_DATA						(0x02)
+// #define FRAME_ERR_SUBCMD					(0x03)
+
+// //#define FRAME_ERR_
+// #define FRAME_STA_SUCCESS					(0x00)
+// #define FRAME_STA_FAILED					(0xFF)
+/***************************************************************************/
+
+
+/**
+	Voice Recognition V3 protocol over any VRTransport.
+*/
+class VRCore{
+public:
+	VRCore(VRTransport *port);
+	
+	int begin(unsigned long baud);
+	
+	typedef enum{
+		PULSE = 0,
+		TOGGLE = 1,
+		SET = 2, 
+		CLEAR = 3
+	}io_mode_t;
+	
+	typedef enum{
+		LEVEL0 = 0,
+		LEVEL1,
+		LEVEL2, 
+		LEVEL3,
+		LEVEL4,
+		LEVEL5,
+		LEVEL6,
+		LEVEL7,
+		LEVEL8,
+		LEVEL9,
+		LEVEL10,
+		LEVEL11,
+		LEVEL12,
+		LEVEL13,
+		LEVEL14,
+		LEVEL15,
+	}pulse_width_level_t;
+	
+	typedef enum{
+		GROUP0 = 0,
+		GROUP1,
+		GROUP2,
+		GROUP3,
+		GROUP4,
+		GROUP5,
+		GROUP6,
+		GROUP7,
+		GROUP_ALL = 0xFF,
+	}group_t;
+	
+	/**
+		asynchronous command callback.
+		handle --> value returned when the command was queued, 0 for recognition.
+		status --> VR_ASYNC_DONE, VR_ASYNC_PROGRESS, VR_ASYNC_ERROR, VR_ASYNC_TIMEOUT
+		buf --> response frame(buf[2] command, buf[3]~ data), 0 if none.
+		len --> frame length.
+	*/
+	typedef void (*cmd_callback_t)(int handle, int status, uint8_t *buf, int len, void *arg);
+	
+	/** records 0~79 as a bit set, see VRRecordSet.h */
+	typedef VRRecordSet RecordSet;
+	
+	typedef enum{
+		GROUP_NONE = 0,
+		GROUP_SYSTEM,
+		GROUP_USER,
+	}group_kind_t;
+	
+	/**
+		typed view of a voice recognized frame, no copy. It points into the 
+		receive buffer and is valid until the next poll().
+	*/
+	class RecognitionResult{
+	public:
+		RecognitionResult() : frame(0) {}
+		explicit RecognitionResult(const uint8_t *buf) : frame(buf) {}
+		
+		bool valid() const { return frame != 0; }
+		/** FF: None Group, 0x8n: User, 0x0n:System */
+		uint8_t groupMode() const { return frame[4]; }
+		group_kind_t groupKind() const {
+			return frame[4] == 0xFF ? GROUP_NONE : ((frame[4]&0x80) ? GROUP_USER : GROUP_SYSTEM);
+		}
+		uint8_t group() const { return frame[4]&0x7F; }
+		uint8_t record() const { return frame[5]; }
+		uint8_t index() const { return frame[6]; }
+		uint8_t signatureLength() const {
+			return frame[7] < frame[1]-7 ? frame[7] : frame[1]-7;
+		}
+		const uint8_t *signature() const { return frame+8; }
+	private:
+		const uint8_t *frame;
+	};
+	
+	int setBaudRate(unsigned long br);
+	long detectBaudRate();
+#if VR_ENABLE_SETTINGS
+	int setIOMode(io_mode_t mode);
+	int resetIO(uint8_t *ios=0, uint8_t len=1);
+	int setPulseWidth(uint8_t level);
+	int setAutoLoad(uint8_t *records=0, uint8_t len = 0);
+	int setAutoLoad(const RecordSet &records);
+    int disableAutoLoad();
+	int restoreSystemSettings();
+#endif
+	int checkSystemSettings(uint8_t* buf);
+	int recognize(uint8_t *buf, int timeout = VR_DEFAULT_TIMEOUT);
+	int recognize(RecognitionResult &res, int timeout = 0);
+#if VR_ENABLE_TRAIN
+	int train(uint8_t *records, uint8_t len=1, uint8_t *buf = 0);
+	int train(uint8_t record, uint8_t *buf = 0);
+	int trainWithSignature(uint8_t record, const void *buf, uint8_t len=0, uint8_t *retbuf = 0);
+	void setPromptCallback(cmd_callback_t cb, void *arg=0);
+#endif
+	int load(uint8_t *records, uint8_t len=1, uint8_t *buf = 0);
+	int load(uint8_t record, uint8_t *buf = 0);
+	int load(const RecordSet &records, uint8_t *buf = 0);
+	int clear();
+	int setSignature(uint8_t record, const void *buf=0, uint8_t len=0);
+	int deleteSignature(uint8_t record);
+    
+	int checkSignature(uint8_t record, uint8_t *buf);
+	int checkRecognizer(uint8_t *buf);
+	
+	/** recognizer shadow */
+	void invalidateRecognizer();
+#if VR_ENABLE_SHADOW
+	int resync();
+	int getRecognizer(uint8_t *buf);
+	int setActiveRecords(uint8_t *records, uint8_t len);
+	int setActiveRecords(const RecordSet &records);
+	long getSavedFrames() { return saved_frames; }
+	long getSavedBytes() { return saved_bytes; }
+#endif
+	int checkRecord(uint8_t *buf, uint8_t *records = 0, uint8_t len = 0);
+	int checkRecord(uint8_t *buf, const RecordSet &records);
+	
+	/** trained record cache */
+	void invalidateRecordCache();
+#if VR_ENABLE_RECORD_CACHE
+	int isTrained(uint8_t record);
+	int getTrainedMap(uint8_t *map);
+	int refreshRecordCache();
+#endif
+	
+#if VR_ENABLE_SIG_CACHE
+	/** signature cache */
+	int loadSignatureCache(bool verify = true);
+	int fillSignatureCache();
+	int getSignature(uint8_t record, uint8_t *buf);
+	void invalidateSignatureCache();
+#endif
+	
+#if VR_ENABLE_GROUP
+	/** group control */
+	int setGroupControl(uint8_t ctrl);
+	int checkGroupControl();
+	int setUserGroup(uint8_t grp, uint8_t *records, uint8_t len);
+	int setUserGroup(uint8_t grp, const RecordSet &records);
+	int checkUserGroup(uint8_t grp, uint8_t *buf);
+	int loadSystemGroup(uint8_t grp, uint8_t *buf=0);
+	int loadUserGroup(uint8_t grp, uint8_t *buf=0);
+#endif
+	
+#if VR_ENABLE_TEST
+	int test(uint8_t cmd, uint8_t *bsr);
+#if VR_ENABLE_ASYNC
+	/** 
+		recognizer snapshot chunk, FRAME_TEST_CHUNK_SIZE bytes. Return 0 to 
+		take it, '<0' to stop the transfer.
+	*/
+	typedef int (*chunk_sink_t)(uint8_t index, const uint8_t *chunk, void *arg);
+	typedef int (*chunk_source_t)(uint8_t index, uint8_t *chunk, void *arg);
+	int snapshotRecognizer(chunk_sink_t sink, void *arg=0, unsigned long *ms=0);
+	int restoreRecognizer(chunk_source_t source, void *arg=0, unsigned long *ms=0);
+#endif
+#endif
+	
+	/** adaptive timeout */
+	void setTimeoutLimits(uint16_t floor, uint16_t ceiling);
+	uint16_t getTimeout(uint8_t cmd);
+	uint16_t getRoundTrip(uint8_t cmd);
+	
+#if VR_ENABLE_ASYNC
+	/** asynchronous commands */
+	int sendAsync(uint8_t cmd, uint8_t *buf, uint8_t len, cmd_callback_t cb=0, void *arg=0, 
+				  uint8_t frames=1, uint16_t timeout=VR_TIMEOUT_AUTO);
+	int loadAsync(uint8_t *records, uint8_t len, cmd_callback_t cb=0, void *arg=0);
+	int clearAsync(cmd_callback_t cb=0, void *arg=0);
+	int checkRecognizerAsync(cmd_callback_t cb, void *arg=0);
+	int checkRecordAsync(uint8_t *records, uint8_t len, cmd_callback_t cb, void *arg=0);
+	int setSignatureAsync(uint8_t record, const void *buf, uint8_t len, cmd_callback_t cb=0, void *arg=0);
+	int checkSignatureAsync(uint8_t record, cmd_callback_t cb, void *arg=0);
+#if VR_ENABLE_TRAIN
+	int trainAsync(uint8_t *records, uint8_t len, cmd_callback_t cb, void *arg=0);
+	int trainWithSignatureAsync(uint8_t record, const void *buf, uint8_t len, cmd_callback_t cb, void *arg=0);
+#endif
+#if VR_ENABLE_GROUP
+	int loadSystemGroupAsync(uint8_t grp, cmd_callback_t cb=0, void *arg=0);
+	int loadUserGroupAsync(uint8_t grp, cmd_callback_t cb=0, void *arg=0);
+#endif
+	void setRecognizeCallback(cmd_callback_t cb, void *arg=0);
+	int process();
+	bool isBusy();
+	
+	/** pipelined batch */
+	void setPipelineDepth(uint8_t depth);
+	void beginBatch(int8_t *status = 0, uint8_t size = 0);
+	int endBatch();
+	
+	/** module profile, see VRProfile.h */
+	int applyProfile(const uint8_t *profile, uint16_t size);
+	int applyProfile_P(const uint8_t *profile);
+#endif
+	
+#if defined(ARDUINO)
+	int writehex(uint8_t *buf, uint8_t len, Print &out = Serial);
+#endif
+	
+/***************************************************************************/
+	/** low level */
+	int len(uint8_t *buf);
+	int cmp(uint8_t *buf, uint8_t *bufcmp, int len  );
+	void cpy(char *buf,  char * pbuf);
+	void sort(uint8_t *buf, int len);
+	int cleanDup(uint8_t *des, uint8_t *buf, int len);
+	void send_pkt(uint8_t *buf, uint8_t len);
+	void send_pkt(uint8_t cmd, uint8_t *buf, uint8_t len);
+	void send_pkt(uint8_t cmd, uint8_t subcmd, uint8_t *buf, uint8_t len);
+	int receive(uint8_t *buf, int len, uint16_t timeout = VR_DEFAULT_TIMEOUT);
+	int receive_pkt(uint8_t *buf, uint16_t timeout = VR_TIMEOUT_AUTO);
+	int poll();
+	void resetReceiver();
+	
+	/** event trace */
+	typedef enum{
+		TRACE_TX,			// frame sent, cmd, frame length
+		TRACE_RX,			// frame received, cmd, frame length
+		TRACE_ERROR,		// error frame, command sent last, error code
+		TRACE_TIMEOUT,		// no response, command sent last, bytes of partial frame
+		TRACE_DISCARD,		// bytes skipped by resync, first byte, number of bytes
+	}trace_event_t;
+	
+	typedef struct{
+		uint16_t ms;		// millis(), low 16 bits
+		uint8_t event;
+		uint8_t cmd;
+		uint8_t val;
+	}trace_t;
+	
+	int readTrace(trace_t *ev);
+	void clearTrace();
+	uint8_t getTraceLost() { return trace_lost; }
+#if defined(ARDUINO)
+	void dumpTrace(Print &out);
+#endif
+	
+	/** link quality */
+	long getSentBytes() { return tx_bytes; }
+	long getReceivedBytes() { return rx_bytes; }
+	long getDiscardedBytes() { return rx_discarded; }
+	long getResyncCount() { return rx_resyncs; }
+	void resetLinkStats();
+/***************************************************************************/
+protected:
+	VRTransport *port;
+	unsigned long baud;
+	unsigned long last_baud;
+	
+	/** receive/scratch buffer */
+	uint8_t vr_buf[VR_BUF_SIZE];
+	
+	/** incremental receiver state */
+	uint8_t rx_cnt;			// bytes of the frame being assembled
+	uint8_t rx_pend;		// bytes in vr_buf, more than rx_cnt after a resync
+	uint8_t rx_done;		// length of the frame returned by poll()
+	uint8_t rx_lost;		// bytes discarded since the last good frame
+	unsigned long rx_millis;	// time of the last received byte
+	long tx_bytes;
+	long rx_bytes;
+	long rx_discarded;
+	long rx_resyncs;
+	
+	void rxDiscard(uint8_t len);
+	void txFlush();
+	
+#if VR_ENABLE_ASYNC
+	typedef struct{
+		uint8_t handle;
+		uint8_t cmd;
+		uint8_t len;
+		uint8_t data[VR_CMD_DATA_SIZE];
+		uint8_t frames;			// response frames expected
+		uint8_t cnt;			// response frames received
+		uint8_t sent;
+		uint8_t batch;			// index in batch, 0xFF: not in batch
+		uint16_t timeout;		// idle timeout
+		unsigned long start_millis;
+		cmd_callback_t cb;
+		void *arg;
+	}cmd_t;
+#endif
+	
+#if VR_ENABLE_SHADOW
+	/** shadow of recognizer, kept from module responses */
+	uint8_t bsr[7];
+	uint8_t bsr_grpm;
+	uint8_t bsr_valid;
+	
+	/** setActiveRecords() traffic saved compared with clear() + load() */
+	long saved_frames;
+	long saved_bytes;
+	
+	void bsrTrack();
+	void bsrFill(uint8_t *buf);
+	bool bsrLoaded(uint8_t *records, uint8_t len);
+#endif
+	
+#if VR_ENABLE_RECORD_CACHE
+	/** trained record cache, bit map of record 0~79 */
+	uint8_t rec_trained[10];
+	uint8_t rec_known[10];
+	
+	void recTrack();
+	void recSet(uint8_t record, uint8_t sta);
+	bool recKnown(uint8_t *records, uint8_t len);
+#endif
+	
+#if VR_ENABLE_SIG_CACHE
+	/** signature cache is loaded or filled, responses update it */
+	uint8_t sig_on;
+#if !(defined(ARDUINO) && defined(__AVR__))
+	/** no EEPROM, cache kept in RAM */
+	uint8_t sig_mem[VR_SIG_CACHE_SIZE];
+#endif
+	
+	void sigTrack();
+	void sigStore(uint8_t record, const uint8_t *sig, uint8_t len);
+	int sigFetch(uint8_t record, uint8_t *buf);
+	int sigStamp(uint16_t *stamp);
+	void sigRestamp();
+	void sigRead(uint16_t addr, void *buf, uint8_t len);
+	void sigWrite(uint16_t addr, const void *buf, uint8_t len);
+#endif
+	
+	void baudSave(unsigned long br);
+	unsigned long baudLoad();
+	
+	/** round trip time estimators, srtt scaled by 8, rttvar scaled by 4 */
+	uint16_t rto_srtt[VR_RTO_CLASSES];
+	uint16_t rto_var[VR_RTO_CLASSES];
+	uint8_t rto_valid;		// bit map of classes with samples
+	uint16_t rto_min;
+	uint16_t rto_max;
+	uint8_t tx_cmd;			// last sent command
+	uint8_t tx_len;			// last sent frame length
+	uint8_t rto_wait;		// response of last sent command is timed
+	uint8_t rto_lost;		// response of last sent command timed out
+	unsigned long tx_millis;
+	
+	uint8_t rtoClass(uint8_t cmd);
+	uint16_t rtoGet(uint8_t cmd, uint8_t len);
+	uint16_t gapTimeout(uint8_t cmd, uint8_t len);
+	void rtoStart(uint8_t cmd, uint8_t len);
+	void rtoTrack();
+	void rtoBackoff(uint8_t cmd);
+	uint16_t wireTime(uint8_t bytes);
+	
+#if VR_ENABLE_TEST && VR_ENABLE_ASYNC
+	void snapshotPass(void *ctx, bool late);
+#endif
+#if VR_ENABLE_ASYNC
+	int profileApply(const uint8_t *profile, uint16_t size, bool flash);
+#endif
+	
+#if VR_ENABLE_ASYNC
+	bool rtoQuiet();
+	
+	cmd_t cmdq[VR_CMD_QUEUE_SIZE];
+	uint8_t cmdq_head;
+	uint8_t cmdq_cnt;
+	uint8_t cmdq_seq;
+	uint8_t cmdq_depth;
+	uint8_t batch_on;
+	uint8_t batch_cnt;
+	uint8_t batch_size;
+	uint8_t batch_fail;
+	uint8_t batch_depth;
+	int8_t *batch_status;
+	cmd_callback_t vr_cb;
+	void *vr_cb_arg;
+	
+	cmd_t *cmdAt(uint8_t i) { return &cmdq[(cmdq_head+i)%VR_CMD_QUEUE_SIZE]; }
+	bool cmdExclusive(cmd_t *c);
+	bool cmdMatch(cmd_t *c);
+	void cmdSend();
+	void cmdFinish(uint8_t i, int status, uint8_t *buf, int len);
+#endif
+	
+#if VR_ENABLE_TRAIN
+	cmd_callback_t prompt_cb;
+	void *prompt_cb_arg;
+#endif
+	
+#if VR_TRACE_SIZE > 0
+	trace_t trace_buf[VR_TRACE_SIZE];
+	uint8_t trace_head;
+	uint8_t trace_cnt;
+#endif
+	uint8_t trace_lost;
+	
+	/** record an event, a few stores, never blocks */
+	void trace(uint8_t event, uint8_t cmd, uint8_t val){
+#if VR_TRACE_SIZE > 0
+		trace_t *t = &trace_buf[trace_head++ & (VR_TRACE_SIZE-1)];
+		t->ms = millis();
+		t->event = event;
+		t->cmd = cmd;
+		t->val = val;
+		if(trace_cnt < VR_TRACE_SIZE){
+			trace_cnt++;
+		}else if(trace_lost != 0xFF){
+			trace_lost++;
+		}
+#else
+		(void)event; (void)cmd; (void)val;
+#endif
+	}
+};
+
+#if VR_TRACE_SIZE > 0
+static_assert((VR_TRACE_SIZE & (VR_TRACE_SIZE-1)) == 0 && VR_TRACE_SIZE <= 128, 
+	"VR_TRACE_SIZE must be a power of 2, 128 at most");
+#endif
+
+/** 
+	vr_buf holds one frame, FRAME_HEAD + LEN + CMD + data + FRAME_END. 
+	Longest responses: voice recognized 9+VR_SIG_MAX, check recognizer, 
+	check record and load group 15, test read 25.
+*/
+static_assert(VR_BUF_SIZE <= 255, "VR_BUF_SIZE must be 255 at most");
+static_assert(VR_BUF_SIZE >= 15, "VR_BUF_SIZE must be 15 at least");
+static_assert(VR_BUF_SIZE >= 9+VR_SIG_MAX, 
+	"VR_BUF_SIZE too small for VR_SIG_MAX, lower VR_SIG_MAX or raise VR_BUF_SIZE");
+#if VR_ENABLE_TEST
+static_assert(VR_BUF_SIZE >= 25, "test() needs VR_BUF_SIZE 25 at least");
+#endif
+#if VR_ENABLE_ASYNC
+static_assert(VR_CMD_DATA_SIZE >= 7, "VR_CMD_DATA_SIZE must hold 7 records");
+#if VR_ENABLE_TEST
+/** restoreRecognizer() and profile recognizer sections: subcommand, index, chunk */
+static_assert(VR_CMD_DATA_SIZE >= FRAME_TEST_CHUNK_SIZE+2, 
+	"VR_CMD_DATA_SIZE must hold a recognizer chunk, 22 at least");
+#endif
+#endif
+#if VR_ENABLE_SIG_CACHE
+static_assert(VR_ENABLE_RECORD_CACHE, "VR_ENABLE_SIG_CACHE needs VR_ENABLE_RECORD_CACHE");
+static_assert(VR_SIG_CACHE_LEN <= VR_SIG_MAX, "VR_SIG_CACHE_LEN must be VR_SIG_MAX at most");
+#if defined(E2END)
+static_assert(VR_SIG_CACHE_BASE+VR_SIG_CACHE_SIZE <= E2END+1, "signature cache does not fit EEPROM");
+#endif
+#if defined(VR_EEPROM_BAUD)
+static_assert(VR_EEPROM_BAUD < VR_SIG_CACHE_BASE || VR_EEPROM_BAUD >= VR_SIG_CACHE_BASE+VR_SIG_CACHE_SIZE, 
+	"VR_EEPROM_BAUD is inside the signature cache");
+#endif
+#endif
+
+#if defined(ARDUINO)
+/**
+	SoftwareSerial transport, only the listening port receives, and not 
+	while it sends.
+*/
+class VRSoftwareSerialTransport : public VRSerialTransport<SoftwareSerial>{
+public:
+	VRSoftwareSerialTransport(SoftwareSerial &serial) : VRSerialTransport<SoftwareSerial>(serial) {}
+	
+	bool isListening() { return serial.isListening(); }
+	bool isFullDuplex() { return false; }
+};
+
+/**
+	Voice Recognition V3 module on a SoftwareSerial port.
+*/
+class VR : public SoftwareSerial, public VRCore{
+public:
+	VR(uint8_t receivePin, uint8_t transmitPin);
+	~VR();
+	
+	void begin(long speed);
+	
+	/** last constructed instance */
+	static VR* getInstance() {
+	   return instance_cnt ? instances[instance_cnt-1] : 0;
+	}
+	static VR* getInstance(uint8_t index) {
+	   return index < instance_cnt ? instances[index] : 0;
+	}
+	static uint8_t getInstanceCount() {
+	   return instance_cnt;
+	}
+	
+private:
+	static VR*  instances[VR_MAX_INSTANCES];
+	static uint8_t instance_cnt;
+	
+	VRSoftwareSerialTransport link;
+};
+
+#if VR_ENABLE_ASYNC
+/**
+	Share the SoftwareSerial receiver among all VR instances. Only one 
+	SoftwareSerial port can listen at a time, VRScheduler gives each 
+	registered module a listen window in turn. It never switches in the 
+	middle of a frame or while an asynchronous command waits for response.
+*/
+class VRScheduler{
+public:
+	VRScheduler(uint16_t window = VR_LISTEN_WINDOW);
+	
+	void setWindow(uint16_t window);
+	int run();
+	
+	VR *current();
+	unsigned long getDwell(uint8_t index);
+	unsigned long getMissed(uint8_t index);
+	void resetStats();
+	
+private:
+	uint16_t window;
+	uint8_t cur;
+	unsigned long start_millis;
+	/** total listening time of each module, ms */
+	unsigned long dwell[VR_MAX_INSTANCES];
+	/** when each module stopped listening */
+	unsigned long left_millis[VR_MAX_INSTANCES];
+	/** windows each module lost waiting for the line */
+	unsigned long missed[VR_MAX_INSTANCES];
+	
+	void select(uint8_t index, unsigned long now);
+};
+#endif
+#endif
+
+/**
+	Voice Recognition V3 module on any serial port class with begin(), e.g. 
+	VRSerial<HardwareSerial> myVR(Serial1);
+*/
+template<class T>
+class VRSerial : public VRCore{
+public:
+	VRSerial(T &serial) : VRCore(&link), link(serial) {}
+	
+private:
+	VRSerialTransport<T> link;
+};
+
+#if VR_ENABLE_TRAIN && VR_ENABLE_ASYNC
+/**
+	Training session driven by process(), loop() keeps running while the 
+	user speaks. Records are trained one command each, typed events report 
+	prompts and results, cancel() stops before the next record.
+*/
+class VRTrainSession{
+public:
+	typedef enum{
+		EVENT_STARTED,		// module prompts for record the first time
+		EVENT_PROMPT,		// prompt of record, text/len
+		EVENT_RESULT,		// record trained, status 00/F0/FE/FF, signature in text/len
+		EVENT_FAILED,		// no answer for record, status VR_ASYNC_ERROR/TIMEOUT
+		EVENT_DONE,			// session over, record 0xFF, status 0, VR_TRAIN_CANCELLED or VR_ASYNC_ERROR
+	}event_type_t;
+	
+	/** text is not 0 terminated, valid during the callback only */
+	typedef struct{
+		uint8_t type;
+		uint8_t record;
+		int status;
+		uint8_t trained;		// records trained(status 00/F0) so far
+		const uint8_t *text;
+		uint8_t len;
+	}event_t;
+	
+	typedef void (*event_callback_t)(const event_t &ev, void *arg);
+	
+	VRTrainSession(VRCore &vr);
+	
+	int begin(const uint8_t *records, uint8_t len, event_callback_t cb, void *arg=0, 
+			  const char * const *sigs=0);
+	void cancel();
+	int run();
+	bool isActive();
+	uint8_t getTrained();
+	
+private:
+	VRCore *vr;
+	const uint8_t *records;
+	const char * const *sigs;
+	uint8_t len;
+	uint8_t cur;
+	uint8_t trained;
+	uint8_t state;
+	uint8_t started;
+	event_callback_t cb;
+	void *arg;
+	
+	void next();
+	void emit(uint8_t type, int status, const uint8_t *text=0, uint8_t len=0);
+	static void onFrame(int handle, int status, uint8_t *buf, int len, void *arg);
+};
+#endif
+
+#endif // __VOICE_RECOGNITION_V3_H
@@ -0,0 +1,290 @@
+/**
+  ******************************************************************************
+  * @file    vr_sample_benchmark.ino
+  * @author  Elechouse Team
+  * @brief   This file measures latency, wire traffic and CPU time of the
+              library functions on a VoiceRecognitionModule
+  ******************************************************************************
+  * @note:
+        Send 'r' to run the benchmark at the current module baud rate.
+        Send '1'~'5' to set module baud rate to 2400, 4800, 9600, 19200,
+        38400, then restart the module(power off/on) and send 'r'.
+
+        Each function runs BENCH_RUNS times, twice: cold(recognizer shadow
+        and record cache invalidated before each call, every call goes to
+        the module) and warm(as an application sees it).
+        p50/p99 --> call latency, us.
+        cpu     --> CPU time inside the library, us. Same as latency for
+                    blocking functions, asynchronous rows show the time
+                    spent in xxxAsync() + process().
+        bytes   --> bytes on the wire per call, both directions.
+
+        BENCH_RECORD ~ BENCH_RECORD+6 should be trained. setSignature()
+        writes module flash, the signature of BENCH_RECORD is restored
+        after the run. recognize() is measured without voice, the cost of
+        checking for a result.
+
+        tests/bench.cpp(make -C tests bench) runs the same rows on the
+        host virtual module, all baud rates in one run.
+  ******************************************************************************
+  * @section  HISTORY
+
+    2026/10/17    Initial version.
+  */
+
+#include <SoftwareSerial.h>
+#include "VoiceRecognitionV3.h"
+
+/**
+  Connection
+  Arduino    VoiceRecognitionModule
+   2   ------->     TX
+   3   ------->     RX
+*/
+VR myVR(2,3);    // 2:RX 3:TX, you can choose your favourite pins.
+
+#define BENCH_RUNS          (32)
+#define BENCH_RECORD        (0)
+#define BENCH_GROUP         (VR::GROUP0)
+
+enum{
+  API_CLEAR,
+  API_LOAD,
+  API_CHECK_RECOGNIZER,
+  API_CHECK_RECORD,
+  API_CHECK_USER_GROUP,
+  API_SET_SIGNATURE,
+  API_LOAD_USER_GROUP,
+  API_RECOGNIZE,
+  API_CLEAR_ASYNC,
+  API_LOAD_ASYNC,
+  API_CHECK_RECOGNIZER_ASYNC,
+  API_NUM,
+};
+
+uint8_t buf[255];
+uint8_t records[7];
+uint8_t sig[32];
+int sig_len;
+unsigned long lat[BENCH_RUNS];
+unsigned long cpu[BENCH_RUNS];
+long br_tab[5] = {2400, 4800, 9600, 19200, 38400};
+
+void printName(uint8_t api)
+{
+  switch(api){
+    case API_CLEAR:
+      Serial.print(F("clear"));
+      break;
+    case API_LOAD:
+      Serial.print(F("load"));
+      break;
+    case API_CHECK_RECOGNIZER:
+      Serial.print(F("checkRecognizer"));
+      break;
+    case API_CHECK_RECORD:
+      Serial.print(F("checkRecord(all)"));
+      break;
+    case API_CHECK_USER_GROUP:
+      Serial.print(F("checkUserGroup(all)"));
+      break;
+    case API_SET_SIGNATURE:
+      Serial.print(F("setSignature"));
+      break;
+    case API_LOAD_USER_GROUP:
+      Serial.print(F("loadUserGroup"));
+      break;
+    case API_RECOGNIZE:
+      Serial.print(F("recognize"));
+      break;
+    case API_CLEAR_ASYNC:
+      Serial.print(F("clearAsync"));
+      break;
+    case API_LOAD_ASYNC:
+      Serial.print(F("loadAsync"));
+      break;
+    case API_CHECK_RECOGNIZER_ASYNC:
+      Serial.print(F("checkRecognizerAsync"));
+      break;
+  }
+}
+
+/** async callback, keep status of finished command */
+int async_status;
+void asyncDone(int handle, int status, uint8_t *buf, int len, void *arg)
+{
+  if(status != VR_ASYNC_PROGRESS){
+    async_status = status;
+  }
+}
+
+/**
+  @brief   call a library function once.
+  @param   api --> API_XXX
+           us --> CPU time inside the library.
+  @retval  '<0' --> failed.
+*/
+int runApi(uint8_t api, unsigned long *us)
+{
+  int ret;
+  unsigned long start = micros();
+
+  switch(api){
+    case API_CLEAR:
+      ret = myVR.clear();
+      break;
+    case API_LOAD:
+      ret = myVR.load(records, 7);
+      break;
+    case API_CHECK_RECOGNIZER:
+      ret = myVR.checkRecognizer(buf);
+      break;
+    case API_CHECK_RECORD:
+      ret = myVR.checkRecord(buf);
+      break;
+    case API_CHECK_USER_GROUP:
+      ret = myVR.checkUserGroup(VR::GROUP_ALL, buf);
+      break;
+    case API_SET_SIGNATURE:
+      ret = myVR.setSignature(BENCH_RECORD, "bench", 5);
+      break;
+    case API_LOAD_USER_GROUP:
+      ret = myVR.loadUserGroup(BENCH_GROUP, buf);
+      break;
+    case API_RECOGNIZE:
+      /** no voice expected, only a failure of the link counts */
+      myVR.recognize(buf, 0);
+      ret = 0;
+      break;
+    default:
+      async_status = VR_ASYNC_PROGRESS;
+      if(api == API_CLEAR_ASYNC){
+        ret = myVR.clearAsync(asyncDone);
+      }else if(api == API_LOAD_ASYNC){
+        ret = myVR.loadAsync(records, 7, asyncDone);
+      }else{
+        ret = myVR.checkRecognizerAsync(asyncDone);
+      }
+      *us = micros() - start;
+      if(ret < 0){
+        return ret;
+      }
+      while(async_status == VR_ASYNC_PROGRESS){
+        start = micros();
+        myVR.process();
+        *us += micros() - start;
+      }
+      return async_status;
+  }
+  *us = micros() - start;
+  return ret;
+}
+
+/** ascending sort */
+void sort(unsigned long *v, int n)
+{
+  int i, j;
+  unsigned long tmp;
+  for(i=1; i<n; i++){
+    tmp = v[i];
+    for(j=i; j>0 && v[j-1]>tmp; j--){
+      v[j] = v[j-1];
+    }
+    v[j] = tmp;
+  }
+}
+
+void bench(uint8_t api, bool cold)
+{
+  int i, fail = 0;
+  long bytes;
+  unsigned long start;
+
+  bytes = myVR.getSentBytes() + myVR.getReceivedBytes();
+  for(i=0; i<BENCH_RUNS; i++){
+    if(cold){
+      myVR.invalidateRecognizer();
+      myVR.invalidateRecordCache();
+    }
+    start = micros();
+    if(runApi(api, &cpu[i]) < 0){
+      fail++;
+    }
+    lat[i] = micros() - start;
+  }
+  bytes = myVR.getSentBytes() + myVR.getReceivedBytes() - bytes;
+
+  sort(lat, BENCH_RUNS);
+  sort(cpu, BENCH_RUNS);
+  printName(api);
+  Serial.print('\t');
+  Serial.print(lat[BENCH_RUNS/2]);
+  Serial.print('\t');
+  Serial.print(lat[(BENCH_RUNS*99+99)/100-1]);
+  Serial.print('\t');
+  Serial.print(cpu[BENCH_RUNS/2]);
+  Serial.print('\t');
+  Serial.print(bytes/BENCH_RUNS);
+  Serial.print('\t');
+  Serial.println(fail);
+}
+
+void benchAll()
+{
+  uint8_t api;
+
+  Serial.print(F("Baud rate: "));
+  Serial.println(myVR.detectBaudRate());
+  sig_len = myVR.checkSignature(BENCH_RECORD, sig);
+  myVR.resetLinkStats();
+
+  for(int cold=1; cold>=0; cold--){
+    Serial.println(cold ? F("\r\n-- cold --") : F("\r\n-- warm --"));
+    Serial.println(F("function\tp50\tp99\tcpu\tbytes\tfail"));
+    for(api=0; api<API_NUM; api++){
+      bench(api, cold);
+    }
+  }
+
+  /** restore signature */
+  if(sig_len >= 0){
+    myVR.setSignature(BENCH_RECORD, sig, sig_len);
+  }
+  Serial.print(F("\r\nresync: "));
+  Serial.print(myVR.getResyncCount());
+  Serial.print(F(", discarded bytes: "));
+  Serial.println(myVR.getDiscardedBytes());
+}
+
+void setup()
+{
+  /** initialize */
+  Serial.begin(115200);
+  Serial.println(F("Elechouse Voice Recognition V3 Module\r\nBenchmark sample"));
+
+  for(int i=0; i<7; i++){
+    records[i] = BENCH_RECORD + i;
+  }
+  if(myVR.detectBaudRate() < 0){
+    Serial.println(F("Not find VoiceRecognitionModule."));
+    Serial.println(F("Please check connection and restart Arduino."));
+    while(1);
+  }
+  benchAll();
+}
+
+void loop()
+{
+  int ch = Serial.read();
+  if(ch == 'r'){
+    benchAll();
+  }else if(ch >= '1' && ch <= '5'){
+    if(myVR.setBaudRate(br_tab[ch-'1']) == 0){
+      Serial.print(F("Module baud rate set to "));
+      Serial.print(br_tab[ch-'1']);
+      Serial.println(F(", restart module and send 'r'."));
+    }else{
+      Serial.println(F("Set baud rate failed."));
+    }
+  }
+}
@@ -36,8 +36,10 @@ uint8_t cmd[CMD_BUF_LEN];
 uint8_t cmd_cnt;
 uint8_t *paraAddr;
 
-uint8_t buf[400];
-uint8_t buflen[32];
+/** frames printed at a time, more are printed on next loop */
+#define FRAME_NUM        4
+uint8_t buf[FRAME_NUM*VR_BUF_SIZE];
+uint8_t buflen[FRAME_NUM];
 
 void setup(void)
 {
@@ -84,7 +86,7 @@ void loop(void)
   /** recieve all packet a time */
   len=0;
   index = 0;
-  while(1){
+  while(index < FRAME_NUM){
     ret = myVR.receive_pkt(buf+len, 50);
     if(ret>0){
       len+=ret;
@@ -278,4 +280,4 @@ void printSeperator()
   }
   Serial.println();
 }
-
+
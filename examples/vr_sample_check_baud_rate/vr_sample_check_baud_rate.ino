@@ -22,25 +22,18 @@
  */
 VR myVR(2,3);    // 2:RX 3:TX, you can choose your favourite pins.
 
-int br[]={
-  2400, 4800, 9600, 19200, 38400
-};
-
 void setup(void)
 {
   /** initialize */
-  int i=0;
+  long br;
   Serial.begin(115200);
   Serial.println("Elechouse Voice Recognition V3 Module\r\nCheck Baud Rate sample");
-  for(i=0; i<5; i++){
-    myVR.begin(br[i]);
-    if(myVR.clear() == 0){
-      Serial.print("Baud rate: ");
-      Serial.println(br[i], DEC);
-      break;
-    }
-  }
-  if(i==5){
+  /** tries the last known rate first, then the others with short probes */
+  br = myVR.detectBaudRate();
+  if(br > 0){
+    Serial.print("Baud rate: ");
+    Serial.println(br, DEC);
+  }else{
     Serial.println("Check baud rate failed. \r\nPlease check the connection, and reset arduino");
   }
 }
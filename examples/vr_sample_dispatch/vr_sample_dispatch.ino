@@ -0,0 +1,88 @@
+/**
+  ******************************************************************************
+  * @file    vr_sample_dispatch.ino
+  * @author  Elechouse Team
+  * @brief   This file provides a demostration on
+              how to run a handler for each recognized record
+  ******************************************************************************
+  * @note:
+        LAMP_ACTIONS maps records to handlers, VR_DISPATCH_TABLE() keeps the
+        table in flash, loop() has no switch. Records 0 and 1 are loaded
+        alone(no group), user group 1 holds record 2 for the fan.
+        Record 0, 1, 2 should be trained.
+  ******************************************************************************
+  * @section  HISTORY
+
+    2026/10/17    Initial version.
+  */
+
+#include <SoftwareSerial.h>
+#include "VoiceRecognitionV3.h"
+#include "VRDispatch.h"
+
+/**
+  Connection
+  Arduino    VoiceRecognitionModule
+   2   ------->     TX
+   3   ------->     RX
+*/
+VR myVR(2,3);    // 2:RX 3:TX, you can choose your favourite pins.
+
+int led = 13;
+int fan = 12;
+
+void lightOn(const VR::RecognitionResult &res)
+{
+  digitalWrite(led, HIGH);
+}
+
+void lightOff(const VR::RecognitionResult &res)
+{
+  digitalWrite(led, LOW);
+}
+
+void fanOn(const VR::RecognitionResult &res)
+{
+  digitalWrite(fan, HIGH);
+}
+
+/** groups with handlers */
+#define LAMP_GROUPS(G) \
+  G(VR_GROUP_NONE) \
+  G(VR_GROUP_USER(1))
+/** group, record, handler */
+#define LAMP_ACTIONS(X) \
+  X(VR_GROUP_NONE, 0, lightOn) \
+  X(VR_GROUP_NONE, 1, lightOff) \
+  X(VR_GROUP_USER(1), 2, fanOn)
+VR_DISPATCH_TABLE(LampActions, LAMP_GROUPS, LAMP_ACTIONS)
+
+void setup()
+{
+  uint8_t records[2] = {0, 1};
+
+  /** initialize */
+  Serial.begin(115200);
+  Serial.println(F("Elechouse Voice Recognition V3 Module\r\nDispatch sample"));
+  pinMode(led, OUTPUT);
+  pinMode(fan, OUTPUT);
+
+  if(myVR.detectBaudRate() < 0){
+    Serial.println(F("Not find VoiceRecognitionModule."));
+    Serial.println(F("Please check connection and restart Arduino."));
+    while(1);
+  }
+  if(myVR.load(records, 2) >= 0){
+    Serial.println(F("Records 0, 1 loaded"));
+  }
+}
+
+void loop()
+{
+  VR::RecognitionResult res;
+
+  if(myVR.recognize(res) > 0 && !LampActions::dispatch(res)){
+    Serial.print(F("No handler for record "));
+    Serial.println(res.record(), DEC);
+  }
+}
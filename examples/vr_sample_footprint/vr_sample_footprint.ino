@@ -0,0 +1,99 @@
+/**
+  ******************************************************************************
+  * @file    vr_sample_footprint.ino
+  * @author  Elechouse Team
+  * @brief   This file prints the static RAM used by the library with the
+              settings of VRConfig.h
+  ******************************************************************************
+  * @note:
+        Build it with the VRConfig.h of your application, open Serial
+        monitor(115200). Sizes are in bytes and known at compile time, no
+        module is needed.
+        Per instance --> one VR object, split into its buffers.
+        Shared      --> VR instance registry, whatever the number of
+                        instances.
+        Free RAM    --> between heap and stack after setup()(AVR only).
+  ******************************************************************************
+  * @section  HISTORY
+
+    2026/10/17    Initial version.
+  */
+
+#include <SoftwareSerial.h>
+#include "VoiceRecognitionV3.h"
+
+/**
+  Connection
+  Arduino    VoiceRecognitionModule
+   2   ------->     TX
+   3   ------->     RX
+*/
+VR myVR(2,3);    // 2:RX 3:TX, you can choose your favourite pins.
+
+void printSize(const __FlashStringHelper *name, unsigned long size)
+{
+  Serial.print(name);
+  Serial.print('\t');
+  Serial.println(size);
+}
+
+void printFeature(const __FlashStringHelper *name, bool on)
+{
+  Serial.print(name);
+  Serial.println(on ? F("\ton") : F("\toff"));
+}
+
+#if defined(__AVR__)
+int freeRam()
+{
+  extern int __heap_start, *__brkval;
+  int v;
+  return (int)&v - (__brkval == 0 ? (int)&__heap_start : (int)__brkval);
+}
+#endif
+
+void setup()
+{
+  /** initialize */
+  Serial.begin(115200);
+  Serial.println(F("Elechouse Voice Recognition V3 Module\r\nFootprint sample"));
+
+  Serial.println(F("\r\n-- features --"));
+  printFeature(F("VR_ENABLE_TRAIN"), VR_ENABLE_TRAIN);
+  printFeature(F("VR_ENABLE_GROUP"), VR_ENABLE_GROUP);
+  printFeature(F("VR_ENABLE_SETTINGS"), VR_ENABLE_SETTINGS);
+  printFeature(F("VR_ENABLE_TEST"), VR_ENABLE_TEST);
+  printFeature(F("VR_ENABLE_ASYNC"), VR_ENABLE_ASYNC);
+  printFeature(F("VR_ENABLE_SHADOW"), VR_ENABLE_SHADOW);
+  printFeature(F("VR_ENABLE_RECORD_CACHE"), VR_ENABLE_RECORD_CACHE);
+  printFeature(F("VR_ENABLE_SIG_CACHE"), VR_ENABLE_SIG_CACHE);
+
+  Serial.println(F("\r\n-- per instance --"));
+  printSize(F("VR object"), sizeof(VR));
+  printSize(F("  SoftwareSerial"), sizeof(SoftwareSerial));
+  printSize(F("  VRCore"), sizeof(VRCore));
+  printSize(F("    receive buffer"), VR_BUF_SIZE);
+  printSize(F("    trace"), VR_TRACE_SIZE*sizeof(VRCore::trace_t));
+
+  Serial.println(F("\r\n-- shared --"));
+  printSize(F("VR registry"), VR_MAX_INSTANCES*sizeof(VR *) + 1);
+#if VR_ENABLE_ASYNC
+  printSize(F("VRScheduler object"), sizeof(VRScheduler));
+#endif
+
+  Serial.println(F("\r\n-- limits --"));
+  printSize(F("VR_SIG_MAX"), VR_SIG_MAX);
+#if VR_ENABLE_ASYNC
+  printSize(F("VR_CMD_QUEUE_SIZE"), VR_CMD_QUEUE_SIZE);
+  printSize(F("VR_CMD_DATA_SIZE"), VR_CMD_DATA_SIZE);
+#endif
+
+#if defined(__AVR__)
+  Serial.println();
+  printSize(F("Free RAM"), freeRam());
+#endif
+}
+
+void loop()
+{
+}
@@ -96,7 +96,6 @@ void loop()
         }
         if(group == 0){
           group = 1;
-          myVR.clear();
           record[0] = switchRecord;
           record[1] = group1Record1;
           record[2] = group1Record2;
@@ -104,13 +103,13 @@ void loop()
           record[4] = group1Record4;
           record[5] = group1Record5;
           record[6] = group1Record6;
-          if(myVR.load(record, 7) >= 0){
+          /** only changed records are sent to the module */
+          if(myVR.setActiveRecords(record, 7) == 0){
             printRecord(record, 7);
             Serial.println(F("loaded."));
           }
         }else{
           group = 0;
-          myVR.clear();
           record[0] = switchRecord;
           record[1] = group0Record1;
           record[2] = group0Record2;
@@ -118,7 +117,8 @@ void loop()
           record[4] = group0Record4;
           record[5] = group0Record5;
           record[6] = group0Record6;
-          if(myVR.load(record, 7) >= 0){
+          /** only changed records are sent to the module */
+          if(myVR.setActiveRecords(record, 7) == 0){
             printRecord(record, 7);
             Serial.println(F("loaded."));
           }
@@ -0,0 +1,78 @@
+/**
+  ******************************************************************************
+  * @file    vr_sample_profile.ino
+  * @author  Elechouse Team
+  * @brief   This file provides a demostration on
+              how to set up a module with one profile
+  ******************************************************************************
+  * @note:
+        LAMP_PROFILE holds signatures, a user group, the autoload list and
+        the IO settings of the module, kept in flash. Send 'a' in Serial
+        monitor to apply it to the connected module, it takes one frame
+        per section.
+  ******************************************************************************
+  * @section  HISTORY
+
+    2026/10/17    Initial version.
+  */
+
+#include <SoftwareSerial.h>
+#include "VoiceRecognitionV3.h"
+#include "VRProfile.h"
+
+/**
+  Connection
+  Arduino    VoiceRecognitionModule
+   2   ------->     TX
+   3   ------->     RX
+*/
+VR myVR(2,3);    // 2:RX 3:TX, you can choose your favourite pins.
+
+const uint8_t lamp_profile[] PROGMEM = {
+  VR_PROFILE_BEGIN,
+  VR_PROFILE_SIGNATURE(0, 'o', 'n'),
+  VR_PROFILE_SIGNATURE(1, 'o', 'f', 'f'),
+  VR_PROFILE_SIGNATURE(2, 'b', 'l', 'i', 'n', 'k'),
+  VR_PROFILE_GROUP(VRCore::GROUP0, 0, 1, 2),
+  VR_PROFILE_AUTOLOAD(0, 1, 2),
+  VR_PROFILE_IO_MODE(VRCore::TOGGLE),
+  VR_PROFILE_PULSE_WIDTH(VRCore::LEVEL4),
+  VR_PROFILE_END
+};
+
+void setup()
+{
+  /** initialize */
+  Serial.begin(115200);
+  Serial.println(F("Elechouse Voice Recognition V3 Module\r\nProfile sample"));
+
+  if(myVR.detectBaudRate() < 0){
+    Serial.println(F("Not find VoiceRecognitionModule."));
+    Serial.println(F("Please check connection and restart Arduino."));
+    while(1);
+  }
+  Serial.print(sizeof(lamp_profile));
+  Serial.println(F(" bytes profile, send 'a' to apply"));
+}
+
+void loop()
+{
+  int ret;
+  unsigned long start;
+
+  if(Serial.read() != 'a'){
+    return;
+  }
+  start = millis();
+  ret = myVR.applyProfile_P(lamp_profile);
+  if(ret < 0){
+    Serial.println(F("Broken profile."));
+  }else if(ret > 0){
+    Serial.print(ret);
+    Serial.println(F(" sections failed."));
+  }else{
+    Serial.print(F("Applied in "));
+    Serial.print(millis() - start);
+    Serial.println(F(" ms"));
+  }
+}
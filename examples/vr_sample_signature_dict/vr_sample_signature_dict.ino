@@ -0,0 +1,104 @@
+/**
+  ******************************************************************************
+  * @file    vr_sample_signature_dict.ino
+  * @author  Elechouse Team
+  * @brief   This file provides a demostration on
+              how to name records without asking the module
+  ******************************************************************************
+  * @note:
+        Names of the records are listed in LAMP_SIGNATURES and kept in
+        flash. Recognized records are printed with their name, no
+        checkSignature() is sent. Type a name in Serial monitor("Send with
+        newline") to load that record.
+        Record 0, 1, 2 should be trained.
+  ******************************************************************************
+  * @section  HISTORY
+
+    2026/10/17    Initial version.
+  */
+
+#include <SoftwareSerial.h>
+#include "VoiceRecognitionV3.h"
+#include "VRSignatureDict.h"
+
+/**
+  Connection
+  Arduino    VoiceRecognitionModule
+   2   ------->     TX
+   3   ------->     RX
+*/
+VR myVR(2,3);    // 2:RX 3:TX, you can choose your favourite pins.
+
+/** record, name */
+#define LAMP_SIGNATURES(X) \
+  X(0, "on") \
+  X(1, "off") \
+  X(2, "blink")
+VR_SIGNATURE_DICT(LampDict, LAMP_SIGNATURES)
+
+char line[16];
+uint8_t line_len;
+
+void printName(uint8_t record)
+{
+  const char *name = LampDict::name(record);
+  if(name != 0){
+    Serial.print((const __FlashStringHelper *)name);
+  }else{
+    Serial.print(F("record "));
+    Serial.print(record, DEC);
+  }
+}
+
+void setup()
+{
+  uint8_t records[3] = {0, 1, 2};
+
+  /** initialize */
+  Serial.begin(115200);
+  Serial.println(F("Elechouse Voice Recognition V3 Module\r\nSignature dictionary sample"));
+
+  if(myVR.detectBaudRate() < 0){
+    Serial.println(F("Not find VoiceRecognitionModule."));
+    Serial.println(F("Please check connection and restart Arduino."));
+    while(1);
+  }
+  if(myVR.load(records, 3) >= 0){
+    Serial.print(LampDict::count());
+    Serial.println(F(" named records loaded"));
+  }
+}
+
+void loop()
+{
+  int ch, record;
+  VR::RecognitionResult res;
+
+  if(myVR.recognize(res) > 0){
+    Serial.print(F("Recognized: "));
+    printName(res.record());
+    Serial.println();
+  }
+
+  ch = Serial.read();
+  if(ch < 0){
+    return;
+  }
+  if(ch != '\n' && ch != '\r'){
+    if(line_len < sizeof(line)){
+      line[line_len++] = ch;
+    }
+    return;
+  }
+  if(line_len == 0){
+    return;
+  }
+  record = LampDict::record(line, line_len);
+  line_len = 0;
+  if(record < 0){
+    Serial.println(F("Unknown name."));
+  }else if(myVR.load((uint8_t)record) >= 0){
+    printName(record);
+    Serial.println(F(" loaded"));
+  }
+}
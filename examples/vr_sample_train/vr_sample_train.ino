@@ -137,9 +137,24 @@ cmd_function_t cmdFunction[CMD_NUM]={      // command handle fuction(function po
 uint8_t buf[255];
 uint8_t records[7]; // save record
 
+/**
+  @brief   Print train prompt of VR module.
+  @param   buf  -->  prompt frame
+             buf[3]  -->  record in training
+             buf[4]~buf[len-2] --> prompt string
+*/
+void printPrompt(int handle, int status, uint8_t *buf, int len, void *arg)
+{
+  Serial.print(F("Record:\t"));
+  Serial.print(buf[3], DEC);
+  Serial.print(F("\t"));
+  Serial.write(buf+4, len-4);
+}
+
 void setup(void)
 {
   myVR.begin(9600);
+  myVR.setPromptCallback(printPrompt);
 
   /** initialize */
   Serial.begin(115200);
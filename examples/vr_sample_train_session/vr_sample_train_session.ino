@@ -0,0 +1,89 @@
+/**
+  ******************************************************************************
+  * @file    vr_sample_train_session.ino
+  * @author  Elechouse Team
+  * @brief   This file provides a demostration on
+              how to train records without blocking loop()
+  ******************************************************************************
+  * @note:
+        Records 0~4 are trained in one session, prompts and results are
+        printed as events while loop() keeps running(LED blinks). Send 'c'
+        in Serial monitor to cancel, the record in training is finished
+        first.
+  ******************************************************************************
+  * @section  HISTORY
+
+    2026/10/17    Initial version.
+  */
+
+#include <SoftwareSerial.h>
+#include "VoiceRecognitionV3.h"
+
+/**
+  Connection
+  Arduino    VoiceRecognitionModule
+   2   ------->     TX
+   3   ------->     RX
+*/
+VR myVR(2,3);    // 2:RX 3:TX, you can choose your favourite pins.
+VRTrainSession session(myVR);
+
+uint8_t records[] = {0, 1, 2, 3, 4};
+const char *sigs[] = {"on", "off", 0, 0, "blink"};
+
+int led = 13;
+unsigned long blink_millis;
+
+void onTrain(const VRTrainSession::event_t &ev, void *arg)
+{
+  switch(ev.type){
+    case VRTrainSession::EVENT_STARTED:
+      Serial.print(F("Record "));
+      Serial.println(ev.record, DEC);
+      break;
+    case VRTrainSession::EVENT_PROMPT:
+      Serial.print(F("  "));
+      Serial.write(ev.text, ev.len);
+      break;
+    case VRTrainSession::EVENT_RESULT:
+      Serial.print(F("  status "));
+      Serial.println(ev.status, HEX);
+      break;
+    case VRTrainSession::EVENT_FAILED:
+      Serial.println(F("  no answer"));
+      break;
+    case VRTrainSession::EVENT_DONE:
+      Serial.print(ev.status == VR_TRAIN_CANCELLED ? F("Cancelled, ") : F("Done, "));
+      Serial.print(ev.trained, DEC);
+      Serial.println(F(" records trained"));
+      break;
+  }
+}
+
+void setup()
+{
+  /** initialize */
+  myVR.begin(9600);
+  Serial.begin(115200);
+  Serial.println(F("Elechouse Voice Recognition V3 Module\r\nTrain session sample"));
+  pinMode(led, OUTPUT);
+
+  if(session.begin(records, sizeof(records), onTrain, 0, sigs) < 0){
+    Serial.println(F("Train session not started."));
+  }
+}
+
+void loop()
+{
+  session.run();
+
+  if(Serial.read() == 'c'){
+    session.cancel();
+  }
+
+  /** loop() is not blocked while the user speaks */
+  if(millis() - blink_millis > 250){
+    blink_millis = millis();
+    digitalWrite(led, !digitalRead(led));
+  }
+}
@@ -0,0 +1,336 @@
+/**
+  ******************************************************************************
+  * @file    bench.cpp
+  * @author  Elechouse Team
+  * @brief   Latency, wire traffic and CPU time of the library functions on
+             the virtual module, at every baud rate.
+  ******************************************************************************
+    @note
+         make bench [TURNAROUND=us] [JITTER=us] [RUNS=n]
+         build/bench [turnaround_us [jitter_us [runs]]]
+
+         Same rows as examples/vr_sample_benchmark, without a board: each
+         function runs RUNS times at 2400, 4800, 9600, 19200 and 38400
+         baud, cold(recognizer shadow and record cache invalidated before
+         each call) and warm. The module answers after turnaround plus
+         0 ~ jitter us, the same sequence every run, so two builds of the
+         library compare number for number.
+         p50/p99 --> call latency, us of virtual time.
+         cpu     --> virtual time inside the library, us. Same as latency
+                     for blocking functions, asynchronous rows count
+                     xxxAsync() + process() only, the sketch runs
+                     BENCH_LOOP_US of other work between process() calls.
+         bytes   --> bytes on the wire per call, both directions.
+
+         The bulk table times the pipelined transfers against the blocking
+         calls doing the same work, one run each: signature cache fill,
+         recognizer snapshot and restore, module profile.
+  ******************************************************************************
+  * @section  HISTORY
+
+    2026/10/17    Initial version.
+
+  ******************************************************************************
+  */
+#include <stdlib.h>
+#include "vr_test.h"
+#include "VRProfile.h"
+
+#define BENCH_RUNS_MAX		(1000)
+#define BENCH_LOOP_US		(200)
+
+enum{
+	API_CLEAR,
+	API_LOAD,
+	API_CHECK_RECOGNIZER,
+	API_CHECK_RECORD,
+	API_CHECK_USER_GROUP,
+	API_SET_SIGNATURE,
+	API_LOAD_USER_GROUP,
+	API_RECOGNIZE,
+	API_CLEAR_ASYNC,
+	API_LOAD_ASYNC,
+	API_CHECK_RECOGNIZER_ASYNC,
+	API_NUM,
+};
+
+static const char *api_name[API_NUM] = {
+	"clear",
+	"load",
+	"checkRecognizer",
+	"checkRecord(all)",
+	"checkUserGroup(all)",
+	"setSignature",
+	"loadUserGroup",
+	"recognize",
+	"clearAsync",
+	"loadAsync",
+	"checkRecognizerAsync",
+};
+
+static const unsigned long br_tab[5] = {2400, 4800, 9600, 19200, 38400};
+
+/** same sections as examples/vr_sample_profile */
+static const uint8_t lamp_profile[] = {
+	VR_PROFILE_BEGIN,
+	VR_PROFILE_SIGNATURE(0, 'o', 'n'),
+	VR_PROFILE_SIGNATURE(1, 'o', 'f', 'f'),
+	VR_PROFILE_SIGNATURE(2, 'b', 'l', 'i', 'n', 'k'),
+	VR_PROFILE_GROUP(VRCore::GROUP0, 0, 1, 2),
+	VR_PROFILE_AUTOLOAD(0, 1, 2),
+	VR_PROFILE_IO_MODE(VRCore::TOGGLE),
+	VR_PROFILE_PULSE_WIDTH(VRCore::LEVEL4),
+	VR_PROFILE_END
+};
+
+static int runs = 32;
+static unsigned long lat[BENCH_RUNS_MAX];
+static unsigned long cpu[BENCH_RUNS_MAX];
+static uint8_t buf[255];
+static uint8_t records[7] = {0, 1, 2, 3, 4, 5, 6};
+static uint8_t bsr_copy[FRAME_TEST_CHUNK_SIZE*FRAME_TEST_CHUNK_NUM];
+
+static unsigned long long now()
+{
+	return VRVirtualModule::micros();
+}
+
+/** async callback, keep status of finished command */
+static void asyncDone(int handle, int status, uint8_t *buf, int len, void *arg)
+{
+	(void)handle;
+	(void)buf;
+	(void)len;
+	if(status != VR_ASYNC_PROGRESS){
+		*(int *)arg = status;
+	}
+}
+
+/**
+	@brief call a library function once.
+	@param us --> virtual time inside the library.
+	@retval '<0' --> failed.
+*/
+static int runApi(VRCore &vr, uint8_t api, unsigned long *us)
+{
+	int ret, status = VR_ASYNC_PROGRESS;
+	unsigned long long start = now();
+
+	switch(api){
+		case API_CLEAR:
+			ret = vr.clear();
+			break;
+		case API_LOAD:
+			ret = vr.load(records, 7);
+			break;
+		case API_CHECK_RECOGNIZER:
+			ret = vr.checkRecognizer(buf);
+			break;
+		case API_CHECK_RECORD:
+			ret = vr.checkRecord(buf);
+			break;
+		case API_CHECK_USER_GROUP:
+			ret = vr.checkUserGroup(VRCore::GROUP_ALL, buf);
+			break;
+		case API_SET_SIGNATURE:
+			ret = vr.setSignature(0, "bench", 5);
+			break;
+		case API_LOAD_USER_GROUP:
+			ret = vr.loadUserGroup(VRCore::GROUP0, buf);
+			break;
+		case API_RECOGNIZE:
+			/** no voice expected, only a failure of the link counts */
+			vr.recognize(buf, 0);
+			ret = 0;
+			break;
+		default:
+			if(api == API_CLEAR_ASYNC){
+				ret = vr.clearAsync(asyncDone, &status);
+			}else if(api == API_LOAD_ASYNC){
+				ret = vr.loadAsync(records, 7, asyncDone, &status);
+			}else{
+				ret = vr.checkRecognizerAsync(asyncDone, &status);
+			}
+			*us = now() - start;
+			if(ret < 0){
+				return ret;
+			}
+			while(status == VR_ASYNC_PROGRESS){
+				VRVirtualModule::advance(BENCH_LOOP_US);
+				start = now();
+				vr.process();
+				*us += now() - start;
+			}
+			return status;
+	}
+	*us = now() - start;
+	return ret;
+}
+
+static int cmpLong(const void *a, const void *b)
+{
+	unsigned long x = *(const unsigned long *)a, y = *(const unsigned long *)b;
+	return x < y ? -1 : x > y;
+}
+
+static void bench(VRCore &vr, uint8_t api, bool cold)
+{
+	int i, fail = 0;
+	long bytes;
+	unsigned long long start;
+
+	bytes = vr.getSentBytes() + vr.getReceivedBytes();
+	for(i=0; i<runs; i++){
+		if(cold){
+			vr.invalidateRecognizer();
+			vr.invalidateRecordCache();
+		}
+		start = now();
+		if(runApi(vr, api, &cpu[i]) < 0){
+			fail++;
+		}
+		lat[i] = now() - start;
+	}
+	bytes = vr.getSentBytes() + vr.getReceivedBytes() - bytes;
+
+	qsort(lat, runs, sizeof(lat[0]), cmpLong);
+	qsort(cpu, runs, sizeof(cpu[0]), cmpLong);
+	printf("%-22s %9lu %9lu %9lu %7ld %5d\n", api_name[api], lat[runs/2],
+		lat[(runs*99+99)/100-1], cpu[runs/2], bytes/runs, fail);
+}
+
+static int chunkSink(uint8_t index, const uint8_t *chunk, void *arg)
+{
+	(void)arg;
+	memcpy(bsr_copy+FRAME_TEST_CHUNK_SIZE*index, chunk, FRAME_TEST_CHUNK_SIZE);
+	return 0;
+}
+
+static int chunkSource(uint8_t index, uint8_t *chunk, void *arg)
+{
+	(void)arg;
+	memcpy(chunk, bsr_copy+FRAME_TEST_CHUNK_SIZE*index, FRAME_TEST_CHUNK_SIZE);
+	return 0;
+}
+
+/** blocking calls doing the work of lamp_profile */
+static int profileBlocking(VRCore &vr)
+{
+	uint8_t rec[3] = {0, 1, 2};
+	int fail = 0;
+	fail += vr.setSignature(0, "on") < 0;
+	fail += vr.setSignature(1, "off") < 0;
+	fail += vr.setSignature(2, "blink") < 0;
+	fail += vr.setUserGroup(VRCore::GROUP0, rec, 3) < 0;
+	fail += vr.setAutoLoad(rec, 3) < 0;
+	fail += vr.setIOMode(VRCore::TOGGLE) < 0;
+	fail += vr.setPulseWidth(VRCore::LEVEL4) < 0;
+	return fail;
+}
+
+/** one bulk row, pipelined and blocking forms, ms */
+static void bulkRow(const char *name, unsigned long long t0, unsigned long long t1,
+					unsigned long long t2, long bytes)
+{
+	printf("%-22s %9llu %9llu %7ld\n", name, (t1-t0+500)/1000, (t2-t1+500)/1000, bytes);
+}
+
+static void bulk(VRCore &vr)
+{
+	unsigned long long t0, t1, t2;
+	long bytes;
+	int i;
+
+	printf("%-22s %9s %9s %7s\n", "bulk, ms", "pipelined", "blocking", "bytes");
+#if VR_ENABLE_SIG_CACHE
+	/** both include the trained record scan of the cache stamp */
+	vr.invalidateRecordCache();
+	bytes = vr.getSentBytes() + vr.getReceivedBytes();
+	t0 = now();
+	vr.fillSignatureCache();
+	t1 = now();
+	bytes = vr.getSentBytes() + vr.getReceivedBytes() - bytes;
+	vr.refreshRecordCache();
+	for(i=0; i<80; i++){
+		vr.checkSignature(i, buf);
+	}
+	t2 = now();
+	bulkRow("fillSignatureCache", t0, t1, t2, bytes);
+#endif
+
+	bytes = vr.getSentBytes() + vr.getReceivedBytes();
+	t0 = now();
+	vr.snapshotRecognizer(chunkSink);
+	t1 = now();
+	bytes = vr.getSentBytes() + vr.getReceivedBytes() - bytes;
+	vr.test(FRAME_CMD_TEST_READ, bsr_copy);
+	t2 = now();
+	bulkRow("snapshotRecognizer", t0, t1, t2, bytes);
+
+	bytes = vr.getSentBytes() + vr.getReceivedBytes();
+	t0 = now();
+	vr.restoreRecognizer(chunkSource);
+	t1 = now();
+	bytes = vr.getSentBytes() + vr.getReceivedBytes() - bytes;
+	vr.test(FRAME_CMD_TEST_WRITE, bsr_copy);
+	t2 = now();
+	bulkRow("restoreRecognizer", t0, t1, t2, bytes);
+
+	bytes = vr.getSentBytes() + vr.getReceivedBytes();
+	t0 = now();
+	vr.applyProfile(lamp_profile, sizeof(lamp_profile));
+	t1 = now();
+	bytes = vr.getSentBytes() + vr.getReceivedBytes() - bytes;
+	profileBlocking(vr);
+	t2 = now();
+	bulkRow("applyProfile", t0, t1, t2, bytes);
+}
+
+static void benchBaud(unsigned long baud, unsigned long turnaround, unsigned long jitter)
+{
+	VRVirtualModule mod(baud);
+	VRCore vr(&mod);
+	char sig[8];
+	int i;
+
+	mod.setTurnaround(turnaround);
+	mod.setJitter(jitter);
+	for(i=0; i<80; i++){
+		snprintf(sig, sizeof(sig), "rec%d", i);
+		mod.train(i, sig);
+	}
+	vr.begin(baud);
+	vr.setUserGroup(VRCore::GROUP0, records, 7);
+	/** round trip times are measured before the runs */
+	vr.checkSystemSettings(buf);
+	vr.resetLinkStats();
+
+	printf("\n== %lu baud, turnaround %lu + 0~%lu us ==\n", baud, turnaround, jitter);
+	for(int cold=1; cold>=0; cold--){
+		printf("%-22s %9s %9s %9s %7s %5s\n", cold ? "-- cold --" : "-- warm --",
+			"p50", "p99", "cpu", "bytes", "fail");
+		for(uint8_t api=0; api<API_NUM; api++){
+			bench(vr, api, cold);
+		}
+	}
+	bulk(vr);
+	printf("resync: %ld, discarded bytes: %ld\n", vr.getResyncCount(), vr.getDiscardedBytes());
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long turnaround = argc > 1 ? strtoul(argv[1], 0, 0) : 3000;
+	unsigned long jitter = argc > 2 ? strtoul(argv[2], 0, 0) : 0;
+	int i;
+
+	if(argc > 3){
+		runs = atoi(argv[3]);
+		if(runs < 1 || runs > BENCH_RUNS_MAX){
+			runs = BENCH_RUNS_MAX;
+		}
+	}
+	for(i=0; i<5; i++){
+		benchBaud(br_tab[i], turnaround, jitter);
+	}
+	return 0;
+}
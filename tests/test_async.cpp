@@ -0,0 +1,277 @@
+/**
+  ******************************************************************************
+  * @file    test_async.cpp
+  * @author  Elechouse Team
+  * @brief   Asynchronous commands and pipelined batches complete.
+  ******************************************************************************
+  */
+#include "vr_test.h"
+
+typedef struct{
+	int done;
+	int status[8];
+	uint8_t data[8];
+}result_t;
+
+/** keep final status and first data byte of each command */
+static void keep(int handle, int status, uint8_t *buf, int len, void *arg)
+{
+	result_t *r = (result_t *)arg;
+	(void)handle;
+	if(status == VR_ASYNC_PROGRESS){
+		return;
+	}
+	r->status[r->done] = status;
+	r->data[r->done] = buf != 0 && len > 4 ? buf[4] : 0xFF;
+	r->done++;
+}
+
+/** record of a recognized frame */
+static void heard(int handle, int status, uint8_t *buf, int len, void *arg)
+{
+	(void)handle;
+	(void)status;
+	(void)len;
+	*(int *)arg = buf[5];
+}
+
+/** queued commands finish in order, one callback each */
+static void queueCompletes()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	result_t r = {};
+	uint8_t rec[2] = {1, 2};
+
+	vr.begin(9600);
+	mod.train(1);
+	mod.train(2);
+	CHECK(vr.loadAsync(rec, 2, keep, &r) > 0);
+	CHECK(vr.checkRecognizerAsync(keep, &r) > 0);
+	CHECK(vr.clearAsync(keep, &r) > 0);
+	CHECK(vrRunFor(vr, 1000) == 0);
+	CHECK_EQ(r.done, 3);
+	CHECK_EQ(r.status[0], VR_ASYNC_DONE);
+	CHECK_EQ(r.status[1], VR_ASYNC_DONE);
+	CHECK_EQ(r.status[2], VR_ASYNC_DONE);
+	/** record number after load status, slot 0 of recognizer */
+	CHECK_EQ(r.data[0], 1);
+	CHECK_EQ(r.data[1], 1);
+	CHECK_EQ(mod.getSlot(0), 0xFF);
+	CHECK(!vr.isBusy());
+}
+
+/** lost response times out, the queue goes on */
+static void timeoutCompletes()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	result_t r = {};
+
+	vr.begin(9600);
+	mod.dropFrames(1);
+	CHECK(vr.checkRecognizerAsync(keep, &r) > 0);
+	CHECK(vr.checkRecognizerAsync(keep, &r) > 0);
+	CHECK(vrRunFor(vr, 5000) == 0);
+	CHECK_EQ(r.done, 2);
+	CHECK_EQ(r.status[0], VR_ASYNC_TIMEOUT);
+	CHECK_EQ(r.status[1], VR_ASYNC_DONE);
+}
+
+/** error frame finishes the command with VR_ASYNC_ERROR */
+static void errorCompletes()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	result_t r = {};
+	uint8_t data = 0;
+
+	vr.begin(9600);
+	CHECK(vr.sendAsync(0x55, &data, 1, keep, &r) > 0);
+	CHECK(vrRunFor(vr, 1000) == 0);
+	CHECK_EQ(r.done, 1);
+	CHECK_EQ(r.status[0], VR_ASYNC_ERROR);
+}
+
+/** batch of signatures, pipelined, status in queued order */
+static void batchCompletes()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	int8_t status[12];
+	uint8_t sig[2];
+	int i;
+
+	vr.begin(9600);
+	memset(status, 0x7F, sizeof(status));
+	vr.beginBatch(status, 12);
+	for(i=0; i<12; i++){
+		sig[0] = 'a'+i;
+		sig[1] = '0'+i;
+		CHECK(vr.setSignatureAsync(i, sig, 2) > 0);
+	}
+	CHECK_EQ(vr.endBatch(), 0);
+	for(i=0; i<12; i++){
+		CHECK_EQ(status[i], 0);
+		CHECK_EQ(mod.getSignature(i, sig), 2);
+		CHECK_EQ(sig[0], 'a'+i);
+	}
+	CHECK(!vr.isBusy());
+}
+
+/** lost response in a batch fails its own command, not the last one */
+static void batchLostResponse()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	result_t r = {};
+	int8_t status[6];
+	int i;
+
+	vr.begin(9600);
+	for(i=0; i<6; i++){
+		mod.train(i, "sig");
+	}
+	/** response of the second command */
+	mod.dropFrames(1, 1);
+	vr.beginBatch(status, 6);
+	for(i=0; i<6; i++){
+		CHECK(vr.checkSignatureAsync(i, keep, &r) > 0);
+	}
+	CHECK_EQ(vr.endBatch(), 1);
+	CHECK_EQ(status[0], 0);
+	CHECK_EQ(status[1], VR_ASYNC_TIMEOUT);
+	for(i=2; i<6; i++){
+		CHECK_EQ(status[i], 0);
+	}
+	/** each command got the response of its own record */
+	CHECK_EQ(r.done, 6);
+	CHECK_EQ(r.status[0], VR_ASYNC_DONE);
+	CHECK_EQ(r.status[1], VR_ASYNC_TIMEOUT);
+	for(i=2; i<6; i++){
+		CHECK_EQ(r.status[i], VR_ASYNC_DONE);
+	}
+
+	/** same for loads, told apart by the first record */
+	vr.clear();
+	mod.dropFrames(1, 0);
+	memset(&r, 0, sizeof(r));
+	vr.beginBatch(status, 3);
+	for(i=0; i<3; i++){
+		uint8_t rec = i;
+		CHECK(vr.loadAsync(&rec, 1, keep, &r) > 0);
+	}
+	CHECK_EQ(vr.endBatch(), 1);
+	CHECK_EQ(status[0], VR_ASYNC_TIMEOUT);
+	CHECK_EQ(status[1], 0);
+	CHECK_EQ(status[2], 0);
+	CHECK_EQ(r.data[1], 1);
+	CHECK_EQ(r.data[2], 2);
+}
+
+/** half duplex port is not pipelined by a batch */
+static void halfDuplexBatch()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	result_t r = {};
+	int8_t status[6];
+	int i;
+
+	vr.begin(9600);
+	mod.setFullDuplex(false);
+	for(i=0; i<6; i++){
+		mod.train(i, "sig");
+	}
+	vr.beginBatch(status, 6);
+	for(i=0; i<6; i++){
+		CHECK(vr.checkSignatureAsync(i, keep, &r) > 0);
+	}
+	CHECK_EQ(vr.endBatch(), 0);
+
+	/** frames sent over responses break them */
+	memset(&r, 0, sizeof(r));
+	vr.setPipelineDepth(3);
+	vr.beginBatch(status, 6);
+	for(i=0; i<6; i++){
+		CHECK(vr.checkSignatureAsync(i, keep, &r) > 0);
+	}
+	CHECK(vr.endBatch() > 0);
+	CHECK(vr.getDiscardedBytes() > 0);
+}
+
+/** a frame sent while responses are in flight keeps the received bytes */
+static void sendKeepsResponse()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	result_t r = {};
+	uint8_t rec = 0;
+
+	vr.begin(9600);
+	CHECK(vr.checkRecognizerAsync(keep, &r) > 0);
+	/** first bytes of the response */
+	while(vr.getReceivedBytes() < 4){
+		vr.process();
+	}
+	vr.send_pkt(FRAME_CMD_CHECK_SIG, &rec, 1);
+	CHECK(vrRunFor(vr, 1000) == 0);
+	CHECK_EQ(r.done, 1);
+	CHECK_EQ(r.status[0], VR_ASYNC_DONE);
+	CHECK_EQ(vr.getDiscardedBytes(), 0);
+}
+
+/** multi-frame command owns the line, later commands wait for it */
+static void exclusiveCompletes()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	result_t r = {};
+	uint8_t sub = FRAME_CMD_TEST_READ;
+	int8_t status[3];
+
+	vr.begin(9600);
+	vr.beginBatch(status, 3);
+	CHECK(vr.sendAsync(FRAME_CMD_TEST, &sub, 1, keep, &r, FRAME_TEST_CHUNK_NUM) > 0);
+	CHECK(vr.checkRecognizerAsync(keep, &r) > 0);
+	CHECK(vr.clearAsync(keep, &r) > 0);
+	CHECK_EQ(vr.endBatch(), 0);
+	CHECK_EQ(r.done, 3);
+	CHECK_EQ(status[0], 0);
+	CHECK_EQ(status[1], 0);
+	CHECK_EQ(status[2], 0);
+}
+
+/** recognized frames go to the recognize callback between responses */
+static void recognizeCallback()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	result_t r = {};
+	int heard_rec = -1;
+
+	vr.begin(9600);
+	mod.train(7, "go");
+	CHECK(vr.load((uint8_t)7) == 0);
+	vr.setRecognizeCallback(heard, &heard_rec);
+	CHECK(mod.speak(7));
+	CHECK(vr.checkRecognizerAsync(keep, &r) > 0);
+	CHECK(vrRunFor(vr, 1000) == 0);
+	CHECK_EQ(r.done, 1);
+	CHECK_EQ(r.status[0], VR_ASYNC_DONE);
+	CHECK_EQ(heard_rec, 7);
+}
+
+int main()
+{
+	RUN(queueCompletes);
+	RUN(timeoutCompletes);
+	RUN(errorCompletes);
+	RUN(batchCompletes);
+	RUN(batchLostResponse);
+	RUN(sendKeepsResponse);
+	RUN(halfDuplexBatch);
+	RUN(exclusiveCompletes);
+	RUN(recognizeCallback);
+	return vrTestResult("test_async");
+}
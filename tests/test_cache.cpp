@@ -0,0 +1,323 @@
+/**
+  ******************************************************************************
+  * @file    test_cache.cpp
+  * @author  Elechouse Team
+  * @brief   Recognizer shadow and trained record cache follow the module.
+  ******************************************************************************
+  */
+#include "vr_test.h"
+
+/** recognizer of the module, same layout as checkRecognizer() */
+static void moduleRecognizer(VRVirtualModule &mod, uint8_t *buf)
+{
+	uint8_t i;
+	buf[0] = 0;
+	buf[9] = 0;
+	for(i=0; i<7; i++){
+		buf[1+i] = mod.getSlot(i);
+		if(mod.getSlot(i) != 0xFF){
+			buf[0]++;
+			buf[9] |= 1<<i;
+		}
+	}
+	buf[8] = buf[0];
+	buf[10] = mod.getGroupMode();
+}
+
+static bool shadowMatches(VRCore &vr, VRVirtualModule &mod)
+{
+	uint8_t shadow[11], real[11];
+	if(vr.getRecognizer(shadow) != 11){
+		return false;
+	}
+	moduleRecognizer(mod, real);
+	return memcmp(shadow, real, 11) == 0;
+}
+
+/** load, clear and groups keep the shadow equal to the module */
+static void shadowFollows()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	uint8_t rec[3] = {2, 5, 9};
+	uint8_t buf[16];
+	unsigned long frames;
+
+	vr.begin(9600);
+	for(int i=0; i<10; i++){
+		mod.train(i);
+	}
+	CHECK(vr.getRecognizer(buf) < 0);
+	CHECK(vr.resync() == 0);
+	CHECK(shadowMatches(vr, mod));
+	CHECK(vr.load(rec, 3) == 0);
+	CHECK(shadowMatches(vr, mod));
+
+	/** loaded already, no frame */
+	frames = mod.getFrames();
+	CHECK(vr.load(rec+1, 2) == 0);
+	CHECK_EQ(mod.getFrames(), frames);
+
+	CHECK(vr.setUserGroup(1, rec, 3) == 0);
+	CHECK(vr.loadUserGroup(1) >= 0);
+	CHECK(shadowMatches(vr, mod));
+	frames = mod.getFrames();
+	CHECK(vr.loadUserGroup(1) >= 0);
+	CHECK_EQ(mod.getFrames(), frames);
+
+	CHECK(vr.clear() == 0);
+	CHECK(shadowMatches(vr, mod));
+	frames = mod.getFrames();
+	CHECK(vr.clear() == 0);
+	CHECK_EQ(mod.getFrames(), frames);
+}
+
+/** setActiveRecords() loads only the missing records */
+static void activeRecords()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	uint8_t a[3] = {1, 2, 3};
+	uint8_t b[4] = {1, 2, 3, 4};
+	uint8_t c[2] = {4, 7};
+	unsigned long frames;
+
+	vr.begin(9600);
+	for(int i=0; i<10; i++){
+		mod.train(i);
+	}
+	CHECK(vr.setActiveRecords(a, 3) == 0);
+	CHECK(shadowMatches(vr, mod));
+	frames = mod.getFrames();
+	CHECK(vr.setActiveRecords(b, 4) == 0);
+	CHECK_EQ(mod.getFrames(), frames+1);
+	CHECK(shadowMatches(vr, mod));
+	CHECK(vr.setActiveRecords(c, 2) == 0);
+	CHECK(shadowMatches(vr, mod));
+	CHECK(vr.getSavedFrames() > 0);
+}
+
+/** module restarted behind the library, shadow is dropped and reread */
+static void moduleRestart()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	uint8_t rec[2] = {0, 1};
+
+	vr.begin(9600);
+	mod.train(0);
+	mod.train(1);
+	CHECK(vr.load(rec, 2) == 0);
+	CHECK(vr.setAutoLoad(rec+1, 1) == 0);
+	mod.restart();
+	CHECK_EQ(mod.getSlot(0), 1);
+	vr.invalidateRecognizer();
+	CHECK(vr.resync() == 0);
+	CHECK(shadowMatches(vr, mod));
+}
+
+/** trained record cache answers checkRecord() like the module */
+static void recordCache()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	uint8_t wire[255], cached[255], buf[16];
+	uint8_t rec[3] = {4, 6, 90};
+	unsigned long frames;
+	int i;
+
+	vr.begin(9600);
+	mod.train(4);
+	mod.train(40);
+	mod.train(79);
+	CHECK_EQ(vr.checkRecord(wire), 3);
+	frames = mod.getFrames();
+	CHECK_EQ(vr.checkRecord(cached), 3);
+	CHECK_EQ(mod.getFrames(), frames);
+	for(i=0; i<80; i++){
+		CHECK_EQ(cached[i], wire[i]);
+	}
+	/** not reported by the cache, as by a short scan */
+	for(i=80; i<255; i++){
+		CHECK_EQ(cached[i], 0xF0);
+	}
+	CHECK_EQ(vr.checkRecord(buf, rec, 3), 1);
+	CHECK_EQ(mod.getFrames(), frames);
+	CHECK_EQ(buf[0], 3);
+	CHECK_EQ(buf[2], 1);
+	CHECK_EQ(buf[4], 0);
+	CHECK_EQ(buf[6], 0xFF);
+
+	/** trained by the library, cache follows without a scan */
+	CHECK(vr.train((uint8_t)6) == 0);
+	CHECK(mod.isTrained(6));
+	frames = mod.getFrames();
+	CHECK_EQ(vr.isTrained(6), 1);
+	CHECK_EQ(mod.getFrames(), frames);
+
+	/** trained elsewhere, the cache is told */
+	mod.untrain(40);
+	vr.invalidateRecordCache();
+	CHECK_EQ(vr.isTrained(40), 0);
+	CHECK_EQ(vr.getTrainedMap(0), 3);
+}
+
+/** failed training makes the record unknown, not untrained */
+static void trainTimeout()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	uint8_t buf[16];
+	unsigned long frames;
+
+	vr.begin(9600);
+	mod.train(8);
+	CHECK_EQ(vr.isTrained(8), 1);
+	mod.failTrain(0xFE);
+	CHECK_EQ(vr.train((uint8_t)8, buf), 3);
+	CHECK_EQ(buf[2], 0xFE);
+	/** asked again, the module is the reference */
+	frames = mod.getFrames();
+	CHECK_EQ(vr.isTrained(8), 0);
+	CHECK_EQ(mod.getFrames(), frames+1);
+
+	mod.train(9);
+	CHECK_EQ(vr.isTrained(9), 1);
+	mod.failTrain(0xFE);
+	CHECK(vr.trainWithSignature(9, "nine", 4, buf) > 0);
+	frames = mod.getFrames();
+	CHECK_EQ(vr.isTrained(9), 0);
+	CHECK_EQ(mod.getFrames(), frames+1);
+
+	CHECK_EQ(vr.train((uint8_t)9, buf), 3);
+	CHECK_EQ(buf[2], 0x00);
+	frames = mod.getFrames();
+	CHECK_EQ(vr.isTrained(9), 1);
+	CHECK_EQ(mod.getFrames(), frames);
+}
+
+/** recognition of a loaded record, signature attached */
+static void recognizeLoaded()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	uint8_t buf[32];
+
+	vr.begin(9600);
+	mod.train(12, "lamp");
+	CHECK(vr.load((uint8_t)12) == 0);
+	CHECK(!mod.speak(13));
+	CHECK(mod.speak(12));
+	CHECK_EQ(vr.recognize(buf, 100), 8);
+	CHECK_EQ(buf[0], 0xFF);
+	CHECK_EQ(buf[1], 12);
+	CHECK_EQ(buf[3], 4);
+	CHECK(memcmp(buf+4, "lamp", 4) == 0);
+	CHECK_EQ(vr.recognize(buf, 10), 0);
+}
+
+/** set forms of load() and checkRecord() */
+static void recordSet()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	VRCore::RecordSet set;
+	uint8_t buf[1+2*80];
+	unsigned long frames;
+	int i;
+
+	vr.begin(9600);
+	mod.train(2);
+	mod.train(9);
+	mod.train(40);
+
+	/** empty set, nothing sent */
+	frames = mod.getFrames();
+	CHECK_EQ(vr.load(set), -1);
+	CHECK_EQ(vr.checkRecord(buf, set), -1);
+	CHECK_EQ(mod.getFrames(), frames);
+
+	for(i=0; i<10; i++){
+		set.add(i);
+	}
+	set.add(40);
+	/** 11 records, two frames */
+	CHECK_EQ(vr.checkRecord(buf, set), 3);
+	CHECK_EQ(mod.getFrames(), frames+2);
+	CHECK_EQ(buf[0], 11);
+	for(i=0; i<10; i++){
+		CHECK_EQ(buf[2*i+1], i);
+		CHECK_EQ(buf[2*i+2], i == 2 || i == 9);
+	}
+	CHECK_EQ(buf[21], 40);
+	CHECK_EQ(buf[22], 1);
+
+	/** known now, from the trained record cache */
+	frames = mod.getFrames();
+	CHECK_EQ(vr.checkRecord(buf, set), 3);
+	CHECK_EQ(mod.getFrames(), frames);
+
+	/** more than 7 records refused, up to 7 loaded */
+	CHECK_EQ(vr.load(set), -1);
+	set.clear();
+	set.add(9);
+	set.add(2);
+	CHECK_EQ(vr.load(set), 0);
+	CHECK_EQ(mod.getSlot(0), 2);
+	CHECK_EQ(mod.getSlot(1), 9);
+}
+
+#if VR_ENABLE_SIG_CACHE
+/** training through the library keeps the signature cache valid after a reset */
+static void sigCacheTrain()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	uint8_t buf[VR_SIG_MAX];
+	unsigned long frames;
+
+	vr.begin(9600);
+	mod.train(0, "zero");
+	mod.train(1);
+	CHECK_EQ(vr.fillSignatureCache(), 1);
+	CHECK_EQ(vr.trainWithSignature(5, "five", 4), 0);
+	CHECK_EQ(vr.train((uint8_t)6), 0);
+
+	/** reset: trained map from the module, signatures from the cache */
+	vr.invalidateRecordCache();
+	CHECK_EQ(vr.loadSignatureCache(true), 80);
+	frames = mod.getFrames();
+	CHECK_EQ(vr.getSignature(5, buf), 4);
+	CHECK(memcmp(buf, "five", 4) == 0);
+	CHECK_EQ(vr.getSignature(6, buf), 0);
+	CHECK_EQ(mod.getFrames(), frames);
+
+	/** trained by another host */
+	mod.train(7);
+	vr.invalidateRecordCache();
+	CHECK_EQ(vr.loadSignatureCache(true), -1);
+
+	/** failed training leaves the record unknown, the cache is refused */
+	CHECK_EQ(vr.fillSignatureCache(), 2);
+	mod.failTrain(0xFE);
+	CHECK_EQ(vr.train((uint8_t)6, buf), 3);
+	CHECK_EQ(buf[2], 0xFE);
+	vr.invalidateRecordCache();
+	CHECK_EQ(vr.loadSignatureCache(true), -1);
+}
+#endif
+
+int main()
+{
+	RUN(shadowFollows);
+	RUN(activeRecords);
+	RUN(moduleRestart);
+	RUN(recordCache);
+	RUN(trainTimeout);
+	RUN(recognizeLoaded);
+	RUN(recordSet);
+#if VR_ENABLE_SIG_CACHE
+	RUN(sigCacheTrain);
+#endif
+	return vrTestResult("test_cache");
+}
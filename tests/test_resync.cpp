@@ -0,0 +1,166 @@
+/**
+  ******************************************************************************
+  * @file    test_resync.cpp
+  * @author  Elechouse Team
+  * @brief   Frame receiver resync: corrupted, lost and late bytes.
+  ******************************************************************************
+  */
+#include "vr_test.h"
+
+/** response head corrupted: frame lost, next command answered */
+static void corruptHead()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	uint8_t buf[16];
+
+	vr.begin(9600);
+	mod.corruptBytes(1);
+	CHECK(vr.checkSystemSettings(buf) < 0);
+	CHECK(vr.getDiscardedBytes() > 0);
+	CHECK(vr.checkSystemSettings(buf) > 0);
+}
+
+/** bad FRAME_END, receiver rescans from the next FRAME_HEAD */
+static void corruptEnd()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	uint8_t buf[16];
+
+	vr.begin(9600);
+	mod.train(3);
+	/** AA 0D 01 ... 0A, 15 bytes */
+	mod.corruptBytes(1, 14);
+	CHECK(vr.checkRecognizer(buf) < 0);
+	CHECK(vr.load((uint8_t)3) == 0);
+	CHECK_EQ(vr.checkRecognizer(buf), 11);
+	CHECK_EQ(buf[1], 3);
+}
+
+/** byte lost inside a frame, gap ends it, next frame is taken whole */
+static void dropInside()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	uint8_t buf[16];
+
+	vr.begin(9600);
+	mod.dropBytes(1, 4);
+	CHECK(vr.checkRecognizer(buf) < 0);
+	CHECK_EQ(vr.checkRecognizer(buf), 11);
+	CHECK_EQ(buf[10], 0xFF);
+}
+
+/** lost response, a late frame is never taken as the next response */
+static void lostFrame()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	uint8_t buf[16];
+
+	vr.begin(9600);
+	mod.train(1, "one");
+	CHECK_EQ(vr.checkSignature(1, buf), 3);
+	mod.dropFrames(1);
+	CHECK(vr.checkSignature(1, buf) < 0);
+	CHECK_EQ(vr.checkRecognizer(buf), 11);
+	CHECK_EQ(vr.checkSignature(1, buf), 3);
+	CHECK(memcmp(buf, "one", 3) == 0);
+}
+
+/** noise between recognized frames costs only the frame it hits */
+static void noisyRecognize()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	VRCore::RecognitionResult res;
+	unsigned long start;
+	int ret;
+
+	vr.begin(9600);
+	mod.train(0, "on");
+	mod.train(1, "off");
+	CHECK(vr.load((uint8_t)0) == 0);
+	CHECK(vr.load((uint8_t)1) == 0);
+	/** length byte of the first frame */
+	mod.corruptBytes(1, 1);
+	CHECK(mod.speak(0));
+	CHECK(mod.speak(1, 10000));
+	start = millis();
+	while((ret = vr.recognize(res)) <= 0 && millis()-start < 100);
+	CHECK(ret > 0);
+	CHECK_EQ(res.record(), 1);
+	CHECK_EQ(res.signatureLength(), 3);
+	CHECK(vr.getResyncCount() > 0);
+}
+
+/** module at another baud rate is found */
+static void detectBaud()
+{
+	VRVirtualModule mod(19200);
+	VRCore vr(&mod);
+	uint8_t buf[16];
+
+	vr.begin(9600);
+	CHECK(vr.checkSystemSettings(buf) < 0);
+	CHECK_EQ(vr.detectBaudRate(), 19200);
+	CHECK(vr.checkSystemSettings(buf) > 0);
+	CHECK(vr.setBaudRate(38400) == 0);
+	mod.restart();
+	CHECK_EQ(vr.detectBaudRate(), 38400);
+}
+
+/** a slow gap inside a multi-frame response does not end it early */
+static void slowFrame()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	uint8_t buf[255];
+	uint8_t bsr[FRAME_TEST_CHUNK_SIZE*FRAME_TEST_CHUNK_NUM];
+	int i;
+
+	vr.begin(9600);
+	mod.train(3);
+	mod.train(70);
+	mod.train(79);
+	for(i=0; i<FRAME_TEST_CHUNK_SIZE*FRAME_TEST_CHUNK_NUM; i++){
+		mod.getRecognizerBuffer()[i] = i;
+	}
+	/** round trips measured, timeouts well below the gap */
+	for(i=0; i<4; i++){
+		vr.invalidateRecordCache();
+		CHECK_EQ(vr.checkRecord(buf), 3);
+		CHECK_EQ(vr.checkUserGroup(VRCore::GROUP_ALL, buf), 8);
+		CHECK_EQ(vr.test(FRAME_CMD_TEST_READ, bsr), 0);
+	}
+	CHECK(vr.getTimeout(FRAME_CMD_CHECK_TRAIN) < 300);
+	CHECK(vr.getTimeout(FRAME_CMD_TEST) < 300);
+
+	vr.invalidateRecordCache();
+	memset(buf, 0, sizeof(buf));
+	mod.delayFrame(300000UL, 10);
+	CHECK_EQ(vr.checkRecord(buf), 3);
+	CHECK_EQ(buf[70], 1);
+	CHECK_EQ(buf[79], 1);
+
+	mod.delayFrame(300000UL, 4);
+	CHECK_EQ(vr.checkUserGroup(VRCore::GROUP_ALL, buf), 8);
+
+	memset(bsr, 0, sizeof(bsr));
+	mod.delayFrame(1500000UL, 5);
+	CHECK_EQ(vr.test(FRAME_CMD_TEST_READ, bsr), 0);
+	CHECK(memcmp(bsr, mod.getRecognizerBuffer(), sizeof(bsr)) == 0);
+}
+
+int main()
+{
+	RUN(corruptHead);
+	RUN(corruptEnd);
+	RUN(dropInside);
+	RUN(lostFrame);
+	RUN(noisyRecognize);
+	RUN(detectBaud);
+	RUN(slowFrame);
+	return vrTestResult("test_resync");
+}
@@ -0,0 +1,165 @@
+/**
+  ******************************************************************************
+  * @file    test_snapshot.cpp
+  * @author  Elechouse Team
+  * @brief   Recognizer snapshot, restore and profile recognizer sections.
+  ******************************************************************************
+  */
+#include "vr_test.h"
+#include "VRProfile.h"
+
+#define BSR_SIZE		(FRAME_TEST_CHUNK_SIZE*FRAME_TEST_CHUNK_NUM)
+
+typedef struct{
+	uint8_t bsr[BSR_SIZE];
+	uint8_t calls[FRAME_TEST_CHUNK_NUM];
+	int8_t stop_at;
+}copy_t;
+
+static void copyInit(copy_t *c)
+{
+	memset(c, 0, sizeof(*c));
+	c->stop_at = -1;
+}
+
+static int sink(uint8_t index, const uint8_t *chunk, void *arg)
+{
+	copy_t *c = (copy_t *)arg;
+	c->calls[index]++;
+	memcpy(c->bsr+FRAME_TEST_CHUNK_SIZE*index, chunk, FRAME_TEST_CHUNK_SIZE);
+	return 0;
+}
+
+static int source(uint8_t index, uint8_t *chunk, void *arg)
+{
+	copy_t *c = (copy_t *)arg;
+	if(index == c->stop_at){
+		return -1;
+	}
+	c->calls[index]++;
+	memcpy(chunk, c->bsr+FRAME_TEST_CHUNK_SIZE*index, FRAME_TEST_CHUNK_SIZE);
+	return 0;
+}
+
+static void pattern(uint8_t *buf, uint8_t seed)
+{
+	for(int i=0; i<BSR_SIZE; i++){
+		buf[i] = seed + i*7;
+	}
+}
+
+/** snapshot reads the module buffer, restore writes it back */
+static void roundTrip()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	copy_t c;
+	int i;
+
+	vr.begin(9600);
+	pattern(mod.getRecognizerBuffer(), 3);
+	copyInit(&c);
+	CHECK_EQ(vr.snapshotRecognizer(sink, &c), 0);
+	CHECK(memcmp(c.bsr, mod.getRecognizerBuffer(), BSR_SIZE) == 0);
+	for(i=0; i<FRAME_TEST_CHUNK_NUM; i++){
+		CHECK_EQ(c.calls[i], 1);
+	}
+
+	memset(mod.getRecognizerBuffer(), 0, BSR_SIZE);
+	memset(c.calls, 0, sizeof(c.calls));
+	CHECK_EQ(vr.restoreRecognizer(source, &c), 0);
+	CHECK(memcmp(c.bsr, mod.getRecognizerBuffer(), BSR_SIZE) == 0);
+	for(i=0; i<FRAME_TEST_CHUNK_NUM; i++){
+		CHECK_EQ(c.calls[i], 1);
+	}
+}
+
+/** a lost chunk comes from the next request, the sink sees it once */
+static void snapshotLostChunk()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	copy_t c;
+	int i;
+
+	vr.begin(9600);
+	pattern(mod.getRecognizerBuffer(), 11);
+	copyInit(&c);
+	mod.dropFrames(1, 3);
+	CHECK_EQ(vr.snapshotRecognizer(sink, &c), 0);
+	CHECK(memcmp(c.bsr, mod.getRecognizerBuffer(), BSR_SIZE) == 0);
+	for(i=0; i<FRAME_TEST_CHUNK_NUM; i++){
+		CHECK_EQ(c.calls[i], 1);
+	}
+}
+
+/** a lost acknowledge is resolved by reading the module back */
+static void restoreLostAck()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	copy_t c;
+
+	vr.begin(9600);
+	copyInit(&c);
+	pattern(c.bsr, 5);
+	mod.dropFrames(1, 4);
+	CHECK_EQ(vr.restoreRecognizer(source, &c), 0);
+	CHECK(memcmp(c.bsr, mod.getRecognizerBuffer(), BSR_SIZE) == 0);
+	CHECK(!vr.isBusy());
+}
+
+/** source stops the transfer, nothing after it is written */
+static void restoreSourceStops()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	copy_t c;
+
+	vr.begin(9600);
+	memset(mod.getRecognizerBuffer(), 0, BSR_SIZE);
+	copyInit(&c);
+	pattern(c.bsr, 9);
+	c.stop_at = 4;
+	CHECK_EQ(vr.restoreRecognizer(source, &c), -1);
+	CHECK(memcmp(c.bsr, mod.getRecognizerBuffer(), 4*FRAME_TEST_CHUNK_SIZE) == 0);
+	CHECK_EQ(mod.getRecognizerBuffer()[4*FRAME_TEST_CHUNK_SIZE], 0);
+	CHECK(!vr.isBusy());
+}
+
+static const uint8_t bsr_profile[] = {
+	VR_PROFILE_BEGIN,
+	VR_PROFILE_IO_MODE(VRCore::TOGGLE),
+	VR_PROFILE_RECOGNIZER(2, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10,
+		11, 12, 13, 14, 15, 16, 17, 18, 19, 20),
+	VR_PROFILE_END
+};
+
+/** recognizer section of a profile, a lost acknowledge counts as failed */
+static void profileRecognizer()
+{
+	VRVirtualModule mod;
+	VRCore vr(&mod);
+	uint8_t *bsr = mod.getRecognizerBuffer();
+
+	vr.begin(9600);
+	memset(bsr, 0, BSR_SIZE);
+	CHECK_EQ(vr.applyProfile(bsr_profile, sizeof(bsr_profile)), 0);
+	CHECK_EQ(bsr[2*FRAME_TEST_CHUNK_SIZE], 1);
+	CHECK_EQ(bsr[3*FRAME_TEST_CHUNK_SIZE-1], 20);
+	CHECK_EQ(mod.getIOMode(), VRCore::TOGGLE);
+
+	mod.dropFrames(1, 1);
+	CHECK_EQ(vr.applyProfile(bsr_profile, sizeof(bsr_profile)), 1);
+	CHECK(!vr.isBusy());
+}
+
+int main()
+{
+	RUN(roundTrip);
+	RUN(snapshotLostChunk);
+	RUN(restoreLostAck);
+	RUN(restoreSourceStops);
+	RUN(profileRecognizer);
+	return vrTestResult("test_snapshot");
+}
@@ -0,0 +1,34 @@
+/**
+  ******************************************************************************
+  * @file    vr_test.cpp
+  * @author  Elechouse Team
+  * @brief   Virtual clock and checks of the host tests.
+  ******************************************************************************
+  */
+#include "vr_test.h"
+
+int vr_test_fail;
+int vr_test_checks;
+
+/** VRCore timeouts run on the clock of the virtual module */
+unsigned long millis()
+{
+	return VRVirtualModule::millis();
+}
+
+int vrRunFor(VRCore &vr, unsigned long ms)
+{
+	unsigned long start = millis();
+	while(millis() - start < ms){
+		if(vr.process() == 0){
+			return 0;
+		}
+	}
+	return -1;
+}
+
+int vrTestResult(const char *name)
+{
+	printf("%s: %d checks, %d failed\n", name, vr_test_checks, vr_test_fail);
+	return vr_test_fail ? 1 : 0;
+}
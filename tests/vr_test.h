@@ -0,0 +1,55 @@
+/**
+  ******************************************************************************
+  * @file    vr_test.h
+  * @author  Elechouse Team
+  * @brief   Checks of the host tests, VRCore against VRVirtualModule.
+  ******************************************************************************
+    @note
+         A test program is one test_xxx.cpp linked with vr_test.cpp, the
+         library and VRVirtualModule.cpp. A failed check is printed and the
+         program exits with 1 at the end, see Makefile.
+  ******************************************************************************
+  */
+#ifndef __VR_TEST_H
+#define __VR_TEST_H
+
+#include <stdio.h>
+#include "VRVirtualModule.h"
+
+extern int vr_test_fail;
+extern int vr_test_checks;
+
+#define CHECK(cond)											\
+	do{														\
+		vr_test_checks++;									\
+		if(!(cond)){										\
+			printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);	\
+			vr_test_fail++;									\
+		}													\
+	}while(0)
+
+#define CHECK_EQ(a, b)										\
+	do{														\
+		long a_ = (long)(a), b_ = (long)(b);				\
+		vr_test_checks++;									\
+		if(a_ != b_){										\
+			printf("%s:%d: CHECK_EQ(%s, %s) failed, %ld != %ld\n",	\
+				__FILE__, __LINE__, #a, #b, a_, b_);		\
+			vr_test_fail++;									\
+		}													\
+	}while(0)
+
+/** run a test function, name is printed */
+#define RUN(test)											\
+	do{														\
+		int fail_ = vr_test_fail;							\
+		test();												\
+		printf("%-40s %s\n", #test, fail_ == vr_test_fail ? "ok" : "FAILED");	\
+	}while(0)
+
+/** process() until the queue is empty or ms of virtual time passed */
+int vrRunFor(VRCore &vr, unsigned long ms);
+/** result of the test program, exit code of main() */
+int vrTestResult(const char *name);
+
+#endif // __VR_TEST_H